@@ -14,15 +14,22 @@
 #include <vector>
 
 #include "adsb_message.h"
+#include "batch.h"
+#include "clock.h"
 #include "config.h"
 #include "contact.h"
 #include "demodulator.h"
+#include "recording.h"
+#include "registry.h"
+#include "replay.h"
 #include "sdr_handler.h"
+#include "sharded_contact_list.h"
+#include "snapshot.h"
 #include "webserver.h"
 
 void ingest_raw_iq_data(SharedBuffer *buffer) {
   int n_buffers = 12;
-  int sample_frequency = 2000000;
+  int sample_frequency = buffer->sample_rate;
 
   // Read:
   SDRHandler handler = SDRHandler(sample_frequency, n_buffers, BUFFER_LEN);
@@ -40,9 +47,14 @@ void ingest_from_file(std::string filename, SharedBuffer *buffer) {
     return;
   }
   unsigned char byte;
+  {
+    std::unique_lock<std::mutex> lock{buffer->mutex};
+    buffer->stream_start = std::chrono::system_clock::now();
+  }
   while (1) {
     {
       std::unique_lock<std::mutex> lock{buffer->mutex};
+      buffer->first_sample = buffer->n_samples;
       for (size_t n = 0; n < buffer->data.size(); n++) {
         if (n < BUFFER_OVERLAP) {
           // fill first BUFFER_OVERLAP bytes with last BUFFER_OVERLAP from
@@ -57,11 +69,13 @@ void ingest_from_file(std::string filename, SharedBuffer *buffer) {
           buffer->has_data = true;
           buffer->has_more = false;
           buffer->len = n;
+          buffer->n_samples += (n - BUFFER_OVERLAP) / 2;
           buffer->data_ready.notify_one();
           file.close();
           return;
         }
       }
+      buffer->n_samples += BUFFER_LEN / 2;
       buffer->has_data = true;
       buffer->data_ready.notify_one();
       buffer->data_ready.wait(lock, [buffer] { return !buffer->has_data; });
@@ -69,59 +83,6 @@ void ingest_from_file(std::string filename, SharedBuffer *buffer) {
   }
 }
 
-void append_demod_output_file(const std::string &filename,
-                              std::vector<ADSBMessage> decoded_messages) {
-  // Open file for output in append mode; create it if it does not exist
-  std::ofstream file(filename,
-                     std::ios::out | std::ios::binary | std::ios::app);
-
-  if (!file) {
-    std::cerr << "Error opening file for writing.\n";
-    return;
-  }
-
-  // update the contactlist
-  for (const auto &msg : decoded_messages) {
-    file.write(reinterpret_cast<const char *>(msg.message.data()),
-               msg.message.size());
-
-    // Serialize and write the timestamp
-    auto duration_since_epoch = msg.timestamp.time_since_epoch();
-
-    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    duration_since_epoch)
-                    .count();
-    file.write(reinterpret_cast<const char *>(&time), sizeof(time));
-
-    if (!file) {
-      std::cerr << "Error writing to file.\n";
-    }
-  }
-  file.close();
-}
-
-void append_raw_output_file(
-    const std::string &filename,
-    const std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP> *data) {
-  // Open file for output in append mode; create it if it does not exist
-  std::ofstream file(filename,
-                     std::ios::out | std::ios::binary | std::ios::app);
-
-  if (!file) {
-    std::cerr << "Error opening file for writing.\n";
-    return;
-  }
-
-  // Write the contents of the array to the file
-  file.write(reinterpret_cast<const char *>(data->data()), data->size());
-
-  if (!file) {
-    std::cerr << "Error writing to file.\n";
-  }
-
-  file.close();
-}
-
 std::string to_string_with_precision(double value, int precision) {
   std::ostringstream out;
   out << std::fixed << std::setprecision(precision) << value;
@@ -142,7 +103,7 @@ std::string display_bool_value(BoolValue value) {
   }
 }
 
-void draw_contact_table(ContactList contacts) {
+void draw_contact_table(std::vector<Contact> contacts) {
   auto now = std::chrono::system_clock::now();
   auto now_in_seconds = std::chrono::system_clock::to_time_t(now);
   std::string spinner = "";
@@ -181,16 +142,17 @@ void draw_contact_table(ContactList contacts) {
             << "VRATE" << std::setw(col_width) << "TYPE" << std::setw(col_width)
             << "APILOT" << std::setw(col_width) << "APPRMODE"
             << std::setw(col_width) << "ALT_HOLD" << std::setw(col_width)
-            << "TCAS" << std::setw(col_width) << "MESSAGES"
+            << "TCAS" << std::setw(col_width) << "RSSI"
+            << std::setw(col_width) << "MESSAGES"
             << std::setw(col_width) << "SEEN" << std::setw(col_width)
 
             << spinner << std::endl;
 
-  std::cout << std::setfill('-') << std::setw(18 * col_width) << ""
+  std::cout << std::setfill('-') << std::setw(19 * col_width) << ""
             << std::endl;
   std::cout << std::setfill(' ');
 
-  for (Contact &contact : contacts.contacts) {
+  for (Contact &contact : contacts) {
     std::cout << std::right << std::setprecision(4) << std ::fixed
               << std::setw(6) << contact.icao << std::setw(col_width)
               << contact.callsign << std::setw(col_width)
@@ -233,32 +195,61 @@ void draw_contact_table(ContactList contacts) {
               << display_bool_value(contact.altitude_hold_mode)
               << std::setw(col_width)
               << display_bool_value(contact.tcas_operational)
+              << std::setw(col_width)
+              << ((contact.signal_status != UNDETERMINED)
+                      ? to_string_with_precision(contact.rssi, 1)
+                      : "")
               << std::setw(col_width) << contact.n_messages
               << std::setw(col_width) << contact.last_seen() << std::endl;
   }
 }
 
-void read_demod_messages(std::string filename,
-                         std::vector<ADSBMessage> *messages) {
-  std::ifstream file(filename, std::ios::in | std::ios::binary);
-  if (!file) {
-    std::cerr << "Error opening file for reading.\n";
-    return;
+void run_batch(const std::string &input_file_path, int n_threads,
+               const DemodulatorSettings &settings,
+               ShardedContactList *contact_list,
+               const std::string &demod_path,
+               const std::string &contacts_path, bool print_contacts_table,
+               bool print_messages) {
+  if (n_threads <= 0) {
+    n_threads = std::max(1u, std::thread::hardware_concurrency());
   }
+  std::vector<ADSBMessage> messages;
+  BatchReport report =
+      process_recording(input_file_path, n_threads, BATCH_SEGMENT_LEN,
+                        settings, &messages);
+
+  // contacts age with the recorded time, the shards are updated in parallel
+  VirtualClock batch_clock;
+  contact_list->set_clock(&batch_clock);
+  if (!messages.empty()) {
+    batch_clock.advance(messages.back().timestamp);
+  }
+  contact_list->update(messages, n_threads);
 
-  while (file) {
-    std::array<unsigned char, 14> message;
-    file.read(reinterpret_cast<char *>(message.data()), message.size());
-
-    long long time_count;
-    file.read(reinterpret_cast<char *>(&time_count), sizeof(time_count));
-    std::chrono::system_clock::time_point timestamp =
-        std::chrono::system_clock::time_point(
-            std::chrono::milliseconds(time_count));
-    messages->push_back(ADSBMessage(message, timestamp));
+  if (!demod_path.empty()) {
+    append_demod_output_file(demod_path, messages);
+  }
+  if (!contacts_path.empty()) {
+    std::ofstream file(contacts_path);
+    if (!file) {
+      std::cerr << "Error opening file for writing.\n";
+    } else {
+      file << contact_list->to_json() << std::endl;
+    }
   }
-  return;
+  if (print_messages) {
+    for (auto &msg : messages) {
+      std::cout << "==============================================="
+                << std::endl;
+      msg.PrintMessage();
+    }
+  }
+  if (print_contacts_table) {
+    draw_contact_table(contact_list->snapshot());
+  }
+  report.print(std::cout);
 }
+
 int main(int argc, char **argv) {
   cxxopts::Options options("ads-boost", "Your awesome ads-b tracker.");
 
@@ -285,8 +276,45 @@ int main(int argc, char **argv) {
       "b,lat_ref", "Latitude reference for ground position messages.",
       cxxopts::value<double>()->default_value("0.0"))(
       "l,lon_ref", "Longitude reference for ground position messages.",
-      cxxopts::value<double>()->default_value("0.0"))("h,help",
-                                                      "Usage of ads-boost.");
+      cxxopts::value<double>()->default_value("0.0"))(
+      "max_range",
+      "Receiver range in NM. Below 180 NM, positions are decoded from the "
+      "first frame relative to lat_ref/lon_ref (0 disables this).",
+      cxxopts::value<double>()->default_value("0.0"))(
+      "batch",
+      "Process the raw IQ file given with -r offline on all cores and "
+      "write the demodulated messages and final contacts to the -o dir.",
+      cxxopts::value<bool>()->default_value("false"))(
+      "threads", "Number of threads for batch mode (0: all cores).",
+      cxxopts::value<int>()->default_value("0"))(
+      "preamble_threshold",
+      "Minimum level in dB of preamble pulses above the noise floor.",
+      cxxopts::value<double>()->default_value(
+          std::to_string(PREAMBLE_THRESHOLD_DB)))(
+      "sample_rate",
+      "Sample rate in samples/s: 2000000, 2400000 or 8000000 (recorded "
+      "input only).",
+      cxxopts::value<int>()->default_value(std::to_string(SAMPLE_RATE)))(
+      "detector",
+      "Preamble detector, comparator or correlator.",
+      cxxopts::value<std::string>()->default_value("comparator"))(
+      "correct_bits",
+      "Number of least confident bits tried to repair frames failing the "
+      "CRC check (0 disables correction).",
+      cxxopts::value<int>()->default_value(std::to_string(CORRECTED_BITS)))(
+      "s,speed",
+      "Replay speed for -i/-r input, e.g. 10x, or max to replay as fast as "
+      "possible.",
+      cxxopts::value<std::string>()->default_value("1x"))(
+      "registry",
+      "Aircraft registry file built with build-registry, adds registration, "
+      "type and operator to the contacts.",
+      cxxopts::value<std::string>())(
+      "snapshot",
+      "Path of a contact snapshot file, restored at startup and rewritten "
+      "periodically (live input only).",
+      cxxopts::value<std::string>())(
+      "h,help", "Usage of ads-boost.");
 
   cxxopts::ParseResult result;
 
@@ -328,10 +356,114 @@ int main(int argc, char **argv) {
   int port = result["port"].as<int>();
   double lat_ref = result["lat_ref"].as<double>();
   double lon_ref = result["lon_ref"].as<double>();
+  double max_range_nm = result["max_range"].as<double>();
+  double replay_speed = parse_replay_speed(result["speed"].as<std::string>());
+  if (replay_speed < 0) {
+    std::cout << "Invalid replay speed: " << result["speed"].as<std::string>()
+              << std::endl;
+    exit(1);
+  }
+  bool replay = result.count("in_demod") || result.count("in_raw");
+  DemodulatorSettings demodulator_settings;
+  demodulator_settings.preamble_threshold_db =
+      result["preamble_threshold"].as<double>();
+  int sample_rate = result["sample_rate"].as<int>();
+  if (!is_supported_sample_rate(sample_rate)) {
+    std::cout << "Unsupported sample rate: " << sample_rate << std::endl;
+    exit(1);
+  }
+  if (!replay && sample_rate > 3200000) {
+    std::cout << "rtl-sdr supports sample rates up to 3.2 MSPS, use "
+              << sample_rate << " with recorded input (-r)." << std::endl;
+    exit(1);
+  }
+  demodulator_settings.sample_rate = sample_rate;
+  demodulator_settings.max_corrected_bits = result["correct_bits"].as<int>();
+  demodulator_settings.detector =
+      parse_detector_type(result["detector"].as<std::string>());
+  if (demodulator_settings.detector == UNKNOWN_DETECTOR) {
+    std::cout << "Unknown preamble detector: "
+              << result["detector"].as<std::string>() << std::endl;
+    exit(1);
+  }
+  if (demodulator_settings.max_corrected_bits < 0 ||
+      demodulator_settings.max_corrected_bits > MAX_CORRECTED_BITS) {
+    std::cout << "Number of bits to correct has to be between 0 and "
+              << MAX_CORRECTED_BITS << "." << std::endl;
+    exit(1);
+  }
+
+  // mapped for the lifetime of the process, pages are read on demand
+  AircraftRegistry registry;
+  if (result.count("registry") &&
+      !registry.open(result["registry"].as<std::string>())) {
+    exit(1);
+  }
+
+  // write demodulated messages and/or raw data to disk
+  std::ostringstream oss;
+  auto timestamp = std::chrono::system_clock::now();
+  std::time_t time = std::chrono::system_clock::to_time_t(timestamp);
+  oss << std::put_time(std::localtime(&time), "%Y_%m_%d_%H_%M_%S");
+  std::string full_output_path;
+  if (result.count("out_raw")) {
+    full_output_path = output_dir + oss.str() + ".bin";
+  }
+  std::string full_output_demod_path;
+  if (result.count("out_demod")) {
+    full_output_demod_path = output_demod_dir + oss.str() + "_demod.bin";
+  }
+
+  if (result["batch"].as<bool>()) {
+    if (!result.count("in_raw")) {
+      std::cout << "Batch mode requires a raw IQ file (-r)." << std::endl;
+      exit(1);
+    }
+    std::string full_output_contacts_path;
+    if (result.count("out_demod")) {
+      full_output_contacts_path =
+          output_demod_dir + oss.str() + "_contacts.json";
+    }
+    ContactList settings = ContactList(timeout_seconds, lat_ref, lon_ref);
+    settings.max_range_nm = max_range_nm;
+    if (registry.is_open()) settings.registry = &registry;
+    ShardedContactList contact_list(CONTACT_SHARDS, settings);
+    run_batch(input_file_path, result["threads"].as<int>(),
+              demodulator_settings, &contact_list,
+              full_output_demod_path, full_output_contacts_path,
+              print_contacts_table, print_messages);
+    return 0;
+  }
 
-  SharedContactList contacts;
-  contacts.contact_list = ContactList(timeout_seconds, lat_ref, lon_ref);
   SharedBuffer buffer;
+  buffer.sample_rate = sample_rate;
+
+  // when replaying, contacts age with the recorded time instead of wall time
+  VirtualClock replay_clock;
+  ReplayEngine replay_engine(&replay_clock, replay_speed);
+
+  ContactList settings = ContactList(timeout_seconds, lat_ref, lon_ref);
+  settings.max_range_nm = max_range_nm;
+  settings.collect_events = network;
+  if (registry.is_open()) settings.registry = &registry;
+  if (replay) {
+    settings.clock = &replay_clock;
+  }
+  SharedContactList contacts;
+  contacts.contact_list = ShardedContactList(CONTACT_SHARDS, settings);
+
+  // warm restart, restored before the first broadcast
+  std::string snapshot_path;
+  if (result.count("snapshot") && !replay) {
+    snapshot_path = result["snapshot"].as<std::string>();
+    std::vector<Contact> snapshot_contacts;
+    if (read_contact_snapshot(snapshot_path, &snapshot_contacts)) {
+      std::cout << "Restored "
+                << contacts.contact_list.restore(std::move(snapshot_contacts))
+                << " contacts from " << snapshot_path << std::endl;
+    }
+  }
+  auto last_snapshot = std::chrono::steady_clock::now();
 
   // Start websocket server thread
   std::thread network_thread;
@@ -349,35 +481,36 @@ int main(int argc, char **argv) {
     }
   }
 
-  // write demodulated messages and/or raw data to disk
-  std::ostringstream oss;
-  auto timestamp = std::chrono::system_clock::now();
-  std::time_t time = std::chrono::system_clock::to_time_t(timestamp);
-  oss << std::put_time(std::localtime(&time), "%Y_%m_%d_%H_%M_%S");
-  std::string full_output_path;
-  if (result.count("out_raw")) {
-    full_output_path = output_dir + oss.str() + ".bin";
-  }
-  std::string full_output_demod_path;
-  if (result.count("out_demod")) {
-    full_output_demod_path = output_demod_dir + oss.str() + "_demod.bin";
+
+  std::vector<ADSBMessage> replay_messages;
+  size_t replay_index = 0;
+  if (result.count("in_demod")) {
+    read_demod_messages(input_demod_file_path, &replay_messages);
   }
+  // kept across buffers for the noise floor estimate
+  Demodulator demodulator = Demodulator(demodulator_settings);
 
   int counter = 0;
   while (1) {
     std::vector<ADSBMessage> decoded_messages;
     bool has_more = true;
-    std::vector<std::array<unsigned char, 14>> messages;
+    std::vector<rawMessage> messages;
+    std::chrono::system_clock::time_point stream_time;
+    StreamClock stream_clock;
     if (!result.count("in_demod")) {
       std::unique_lock<std::mutex> lock{buffer.mutex};
       buffer.data_ready.wait(lock, [&buffer] { return buffer.has_data; });
+      // frames are timed by their sample index in the stream
+      stream_clock = {buffer.stream_start, buffer.sample_rate};
+      stream_time = stream_clock.to_time(buffer.n_samples);
 
       // Demod: raw bytes -> raw messages
-      Demodulator demodulator = Demodulator();
-      demodulator.Demodulate(&buffer.data, buffer.len, &messages);
+      demodulator.Demodulate(&buffer.data, buffer.len,
+                             int64_t(buffer.first_sample) - BUFFER_OVERLAP / 2,
+                             &messages);
 
       if (result.count("out_raw")) {
-        append_raw_output_file(full_output_path, &buffer.data);
+        append_raw_output_file(full_output_path, &buffer.data, buffer.len);
       }
       if (buffer.has_more) {
         buffer.has_data = false;
@@ -386,32 +519,69 @@ int main(int argc, char **argv) {
         has_more = false;
       }
       // decode messages
-      for (std::size_t n_msg = 0; n_msg < messages.size(); n_msg++) {
-        ADSBMessage msg = ADSBMessage(messages[n_msg]);
-        decoded_messages.push_back(msg);
+      for (const rawMessage &raw_message : messages) {
+        decoded_messages.push_back(
+            decode_raw_message(raw_message, stream_clock));
       }
     } else {
-      // read full demod file
-      read_demod_messages(input_demod_file_path, &decoded_messages);
-      has_more = false;
+      // replay the demod file in slices of REPLAY_SLICE_MS recorded time
+      if (replay_index < replay_messages.size()) {
+        auto slice_end = replay_messages[replay_index].timestamp +
+                         std::chrono::milliseconds(REPLAY_SLICE_MS);
+        while (replay_index < replay_messages.size() &&
+               replay_messages[replay_index].timestamp < slice_end) {
+          decoded_messages.push_back(replay_messages[replay_index]);
+          replay_index++;
+        }
+        stream_time = decoded_messages.back().timestamp;
+      }
+      has_more = replay_index < replay_messages.size();
     }
 
-    // update the contactlist
-    {
-      std::unique_lock<std::mutex> lock{contacts.mutex};
-      for (const auto &msg : decoded_messages) {
-        if (msg.downlink_format == 17) {
-          counter++;
-          contacts.contact_list.update(msg);
+    if (replay && !decoded_messages.empty()) {
+      replay_engine.advance_to(stream_time);
+    }
+
+    // update the contactlist, each message only locks the shard of its
+    // address
+    bool alert_changed = false;
+    int n_updates = 0;
+    for (const auto &msg : decoded_messages) {
+      if (is_tracked_format(msg.downlink_format)) {
+        n_updates++;
+        alert_changed |= contacts.contact_list.update(msg);
+        if (replay) {
+          replay_engine.count_contact(msg.icao);
         }
       }
+    }
+    contacts.contact_list.expire();
+    std::vector<ContactEvent> events = contacts.contact_list.take_events();
+    counter += n_updates;
+    replay_engine.count(decoded_messages.size(), n_updates);
+    {
+      std::unique_lock<std::mutex> lock{contacts.mutex};
       contacts.contacts_updated = true;
       contacts.contacts_ready.notify_all();
     }
+    // emergencies and resolution advisories skip the broadcast interval
+    if (network) {
+      publish_events(std::move(events));
+      if (alert_changed) broadcast_now(&contacts);
+    }
 
     // draw contacts table
     if (print_contacts_table) {
-      draw_contact_table(contacts.contact_list);
+      draw_contact_table(contacts.contact_list.snapshot());
+      if (!result.count("in_demod")) {
+        std::cout << std::fixed << "Noise floor: " << std::setprecision(1)
+                  << demodulator.noise_floor << " dBFS, DC: "
+                  << demodulator.iq_estimate.dc_i << "/"
+                  << demodulator.iq_estimate.dc_q << ", Q gain: "
+                  << std::setprecision(2) << demodulator.iq_estimate.gain_q
+                  << ", ";
+        demodulator.stats.print(std::cout);
+      }
     }
 
     // decode and print decoded messages
@@ -428,12 +598,25 @@ int main(int argc, char **argv) {
       append_demod_output_file(full_output_demod_path, decoded_messages);
     }
 
+    if (!snapshot_path.empty() &&
+        std::chrono::steady_clock::now() - last_snapshot >=
+            std::chrono::seconds(SNAPSHOT_INTERVAL_S)) {
+      write_contact_snapshot(snapshot_path, contacts.contact_list.snapshot());
+      last_snapshot = std::chrono::steady_clock::now();
+    }
+
     if (!has_more) {
       break;
     }
   }
 
   std::cout << "Counter: " << counter << std::endl;
+  if (!result.count("in_demod")) {
+    demodulator.stats.print(std::cout);
+  }
+  if (replay) {
+    replay_engine.print_report(std::cout);
+  }
   if (network) {
     network_thread.join();
   }
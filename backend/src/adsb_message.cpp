@@ -7,6 +7,64 @@
 #include <iostream>
 #include <sstream>
 
+#include "comm_b.h"
+#include "cpr.h"
+#include "crc.h"
+#include "frame_view.h"
+
+namespace {
+
+constexpr int INVALID_GILLHAM = -10000;
+
+// altitude in 100 ft of an 11 bit Gillham code, ordered as in the message:
+// C1 A1 C2 A2 C4 A4 B1 B2 D2 B4 D4
+constexpr int gillham_to_hundreds(int code) {
+  auto bit = [code](int n) { return (code >> (10 - n)) & 1; };
+  // the D, A and B pulses count 500 ft in a reflected Gray code, the C pulses
+  // the 100 ft steps within the cycle 001 011 010 110 100
+  int five_hundreds = 0;
+  const int weights[] = {0xff, 0x7f, 0x3f, 0x1f, 0x0f, 0x07, 0x03, 0x01};
+  const int positions[] = {8, 10, 1, 3, 5, 6, 7, 9};  // D2 D4 A1 A2 A4 B1 B2 B4
+  for (int n = 0; n < 8; n++) {
+    if (bit(positions[n])) five_hundreds ^= weights[n];
+  }
+  int hundreds = (bit(0) ? 7 : 0) ^ (bit(2) ? 3 : 0) ^ (bit(4) ? 1 : 0);
+  if ((hundreds & 5) == 5) hundreds ^= 2;
+  if (hundreds < 1 || hundreds > 5) return INVALID_GILLHAM;
+  if (five_hundreds & 1) hundreds = 6 - hundreds;
+  return 5 * five_hundreds + hundreds - 13;
+}
+
+constexpr std::array<int16_t, 2048> make_gillham_table() {
+  std::array<int16_t, 2048> table = {};
+  for (int code = 0; code < 2048; code++) {
+    table[code] = gillham_to_hundreds(code);
+  }
+  return table;
+}
+
+constexpr std::array<int16_t, 2048> gillham_table = make_gillham_table();
+
+// -1200 ft is C4 alone, 0 ft C2 B2 B4
+static_assert(gillham_table[0b00001000000] == -12 &&
+                  gillham_table[0b00100001010] == 0 &&
+                  gillham_table[0] == INVALID_GILLHAM,
+              "Gillham altitude table");
+
+// 13 bit identity code: C1 A1 C2 A2 C4 A4 X B1 D1 B2 D2 B4 D4
+std::string id13_to_squawk(int id) {
+  auto bit = [id](int n) { return (id >> (12 - n)) & 1; };
+  int a = bit(5) << 2 | bit(3) << 1 | bit(1);
+  int b = bit(11) << 2 | bit(9) << 1 | bit(7);
+  int c = bit(4) << 2 | bit(2) << 1 | bit(0);
+  int d = bit(12) << 2 | bit(10) << 1 | bit(8);
+  char buf[5];
+  std::snprintf(buf, sizeof(buf), "%d%d%d%d", a, b, c, d);
+  return std::string(buf);
+}
+
+}  // namespace
+
 ADSBMessage::ADSBMessage(std::array<unsigned char, 14> message) {
   timestamp = std::chrono::system_clock::now();
   this->init(message, timestamp);
@@ -17,14 +75,48 @@ ADSBMessage::ADSBMessage(std::array<unsigned char, 14> message,
   this->init(message, timestamp);
 }
 
+ADSBMessage::ADSBMessage(std::array<unsigned char, 14> message,
+                         std::chrono::system_clock::time_point timestamp,
+                         uint64_t timestamp_12mhz) {
+  this->timestamp_12mhz = timestamp_12mhz;
+  this->init(message, timestamp);
+}
+
 void ADSBMessage::init(std::array<unsigned char, 14> message,
                        std::chrono::system_clock::time_point timestamp) {
   this->message = message;
   this->timestamp = timestamp;
   downlink_format = decode_downlink_format(message);
   downlink_capability = decode_capability(message);
-  icao = decode_icao(message);
-  type_code = decode_msg_type(message);
+  if (downlink_format == 17 || downlink_format == 18) {
+    type_code = decode_msg_type(message);
+  }
+  if (has_address_parity(downlink_format)) {
+    // the address is only contained in the parity
+    char buf[7];
+    std::snprintf(buf, sizeof(buf), "%06X", crc_syndrome(&message));
+    icao = std::string(buf);
+  } else {
+    icao = decode_icao(message);
+  }
+
+  switch (downlink_format) {
+    case 0:
+    case 16:
+      altitude = decode_ac13_altitude(message, altitude_type);
+      break;
+    case 4:
+    case 20:
+      flight_status = decode_flight_status(message);
+      altitude = decode_ac13_altitude(message, altitude_type);
+      break;
+    case 5:
+    case 21:
+      flight_status = decode_flight_status(message);
+      squawk = decode_squawk(message);
+      break;
+  }
+  decode_comm_b(this);
 
   if (type_code >= 1 && type_code <= 4) {
     // aircraft identification
@@ -80,7 +172,7 @@ void ADSBMessage::init(std::array<unsigned char, 14> message,
     altitude = decode_gnss_altitude(message, altitude_type);
 
   } else if (type_code == 29) {
-    int subtype = (message[4] >> 1) & 3;
+    int subtype = FrameView(message).bits<38, 39>();
     if (subtype == 1) {
       // ADSB version 2
       selected_altitude = decode_selected_altitude(message);
@@ -99,15 +191,43 @@ void ADSBMessage::init(std::array<unsigned char, 14> message,
       baro_pressure_setting_status = KNOWN;
 
     } else if (subtype == 0) {
-      // TODO: ADSB version 1
+      // ADSB version 1, target altitude and heading
+      selected_altitude =
+          decode_target_altitude(message, selected_altitude_status);
+      selected_altitude_source = decode_target_altitude_source(message);
+      selected_heading =
+          decode_target_heading(message, selected_heading_status);
+      emergency_state = decode_emergency_state(message);
     }
 
     tcas_operational = decode_tcas_operational(message);
+
+  } else if (type_code == 28) {
+    // aircraft status
+    int subtype = decode_tc28_subtype(message);
+    if (subtype == 1) {
+      emergency_state = decode_emergency_state(message);
+      squawk = decode_emergency_squawk(message);
+    } else if (subtype == 2) {
+      acas_ra = decode_acas_ra(message);
+      acas_ra_complement = decode_acas_ra_complement(message);
+      acas_ra_terminated = decode_acas_ra_terminated(message);
+      acas_multiple_threats = decode_acas_multiple_threats(message);
+      acas_ra_status = KNOWN;
+    }
+
+  } else if (type_code == 31) {
+    // operational status, accuracy fields from version 1 on
+    adsb_version = decode_adsb_version(message);
+    if (adsb_version >= 1) {
+      nac_p = decode_nac_p(message);
+      sil = decode_sil(message);
+    }
   }
 }
 std::string ADSBMessage::HexString() {
   std::stringstream hex_stream;
-  for (int n = 0; n < 14; n++) {
+  for (int n = 0; n < message_bits(downlink_format) / 8; n++) {
     int byte = static_cast<int>(message[n]);
     // Print each byte in hex format
     hex_stream << std::hex << std::setw(2) << std::setfill('0') << byte;
@@ -120,7 +240,12 @@ void ADSBMessage::PrintMessage() {
   std::cout << "0x" << this->HexString() << std::endl;
   std::cout << "Received "
             << std::put_time(std::localtime(&time), "%Y-%m-%d %H:%M:%S")
+            << " (12 MHz timestamp: " << timestamp_12mhz << ")"
             << std::endl;
+  if (signal_status == KNOWN) {
+    std::cout << "RSSI: " << rssi << " dBFS, noise: " << noise << " dBFS"
+              << std::endl;
+  }
   std::cout << "DF: " << downlink_format << std::endl;
   std::cout << "Capability: " << downlink_capability << std::endl;
   std::cout << "ICAO: " << icao << std::endl;
@@ -128,6 +253,38 @@ void ADSBMessage::PrintMessage() {
             << detailed_type_code(type_code) << ")\n"
             << std::endl;
 
+  if (flight_status >= 0) {
+    std::cout << "Flight status: " << flight_status << std::endl;
+  }
+  if (downlink_format == 0 || downlink_format == 4 || downlink_format == 16 ||
+      downlink_format == 20) {
+    std::cout << "ALT: " << altitude << " ft" << std::endl;
+    std::cout << "ALT Type: " << altitude_type_to_string(altitude_type)
+              << std::endl;
+  }
+  if (!squawk.empty()) {
+    std::cout << "Squawk: " << squawk << std::endl;
+  }
+  if (downlink_format == 20 || downlink_format == 21) {
+    std::cout << "BDS: " << bds_to_string(bds) << std::endl;
+    if (bds == BDS20) {
+      std::cout << "Callsign: " << callsign << std::endl;
+    } else if (bds == BDS40) {
+      std::cout << "selected ALT: " << selected_altitude << " ft" << std::endl;
+      std::cout << "selected ALT source: "
+                << selected_altitude_source_to_string(selected_altitude_source)
+                << std::endl;
+      std::cout << "Barom. pressure setting: " << baro_pressure_setting
+                << std::endl;
+    } else if (bds == BDS50) {
+      std::cout << "Roll angle: " << roll_angle << std::endl;
+      std::cout << "TAS: " << true_airspeed << " kt" << std::endl;
+    } else if (bds == BDS60) {
+      std::cout << "Magnetic HDG: " << magnetic_heading << std::endl;
+      std::cout << "Mach: " << mach << std::endl;
+    }
+  }
+
   if (type_code >= 1 && type_code <= 4) {
     // aircraft identification
     std::cout << "Aircraft category: " << aircraft_category << " ("
@@ -204,130 +361,138 @@ void ADSBMessage::PrintMessage() {
               << std::endl;
     std::cout << "TCAS operational: " << bool_value_to_string(tcas_operational)
               << std::endl;
+  } else if (type_code == 28) {
+    // aircraft status
+    if (emergency_state != UNDETERMINED_EMERGENCY) {
+      std::cout << "Emergency: " << emergency_state_to_string(emergency_state)
+                << std::endl;
+    }
+    if (acas_ra_status == KNOWN) {
+      std::cout << "ACAS RA: "
+                << acas_ra_to_string(acas_ra, acas_multiple_threats)
+                << std::endl;
+      std::cout << "RA terminated: " << bool_value_to_string(acas_ra_terminated)
+                << std::endl;
+    }
+  } else if (type_code == 31) {
+    // operational status
+    std::cout << "ADS-B version: " << adsb_version << std::endl;
+    std::cout << "NACp: " << nac_p << std::endl;
+    std::cout << "SIL: " << sil << std::endl;
   }
 }
 
-int decode_downlink_format(std::array<unsigned char, 14> message) {
-  return (message[0] >> 3);
+int decode_downlink_format(const std::array<unsigned char, 14>& message) {
+  return FrameView(message).downlink_format();
 }
 
-int decode_capability(std::array<unsigned char, 14> message) {
-  return (message[0] & 7);
+int message_bits(int downlink_format) {
+  return downlink_format < 16 ? 56 : 112;
 }
 
-std::string decode_icao(std::array<unsigned char, 14> message) {
+bool has_address_parity(int downlink_format) {
+  switch (downlink_format) {
+    case 0:
+    case 4:
+    case 5:
+    case 16:
+    case 20:
+    case 21:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool is_tracked_format(int downlink_format) {
+  return downlink_format == 11 || downlink_format == 17 ||
+         has_address_parity(downlink_format);
+}
+
+int decode_flight_status(const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bits<6, 8>();
+}
+
+// 13 bit altitude code of surveillance and Comm-B replies, bits 20-32
+int decode_ac13_altitude(const std::array<unsigned char, 14>& message,
+                         AltitudeType& altitude_type) {
+  FrameView frame(message);
+  int n =
+      frame.bits<20, 25>() << 5 | frame.bit<27>() << 4 | frame.bits<29, 32>();
+  if (frame.bit<26>()) {
+    // metric altitudes (M = 1) are not decoded
+    altitude_type = UNDETERMINED_ALT;
+    return 0;
+  } else if (frame.bit<28>()) {
+    altitude_type = BAROMETRIC_ALT;
+    return 25 * n - 1000;
+  }
+  return decode_gillham_altitude(n, altitude_type);
+}
+
+int decode_gillham_altitude(int code, AltitudeType& altitude_type) {
+  int hundreds = gillham_table[code & 0x7ff];
+  if (hundreds == INVALID_GILLHAM) {
+    altitude_type = UNDETERMINED_ALT;
+    return 0;
+  }
+  altitude_type = BAROMETRIC_ALT;
+  return 100 * hundreds;
+}
+
+// 13 bit identity code, bits 20-32
+std::string decode_squawk(const std::array<unsigned char, 14>& message) {
+  return id13_to_squawk(FrameView(message).bits<20, 32>());
+}
+
+int decode_capability(const std::array<unsigned char, 14>& message) {
+  return FrameView(message).capability();
+}
+
+std::string decode_icao(const std::array<unsigned char, 14>& message) {
   char buf[7];
-  std::snprintf(buf, sizeof(buf), "%02X%02X%02X", message[1], message[2],
-                message[3]);
+  std::snprintf(buf, sizeof(buf), "%06X", FrameView(message).address());
   std::string icao(buf);
   return icao;
 }
 
-int decode_msg_type(std::array<unsigned char, 14> message) {
-  return message[4] >> 3;
+int decode_msg_type(const std::array<unsigned char, 14>& message) {
+  return FrameView(message).type_code();
 }
 
-std::string decode_callsign(std::array<unsigned char, 14> message) {
-  char callsign[9];
+std::string decode_callsign(const std::array<unsigned char, 14>& message) {
+  FrameView frame(message);
   std::string char_map =
       "#ABCDEFGHIJKLMNOPQRSTUVWXYZ##### ###############0123456789######";
-  callsign[0] = char_map[message[5] >> 2];
-  callsign[1] = char_map[(message[5] & 3) << 4 | (message[6] >> 4)];
-  callsign[2] = char_map[(message[6] & 15) << 2 | (message[7] >> 6)];
-  callsign[3] = char_map[message[7] & 63];
-  callsign[4] = char_map[message[8] >> 2];
-  callsign[5] = char_map[((message[8] & 3) << 4) | (message[9] >> 4)];
-  callsign[6] = char_map[(message[9] & 15) << 2 | message[10] >> 6];
-  callsign[7] = char_map[message[10] & 63];
-  callsign[8] = '\0';
-
-  return std::string(callsign);
-}
-
-int decode_category(std::array<unsigned char, 14> message) {
-  return message[4] & 7;
-}
-int decode_cpr_format(std::array<unsigned char, 14> message) {
-  return (message[6] & 4) >> 2;
-}
-
-double get_lat_cpr(std::array<unsigned char, 14> message) {
-  return ((message[6] & 3) << 15 | (message[7] << 7) | (message[8] >> 1)) /
-         131072.0;
-}
-
-double get_lon_cpr(std::array<unsigned char, 14> message) {
-  return ((message[8] & 1) << 16 | (message[9] << 8) | (message[10])) /
-         131072.0;
-}
-
-int compute_NL(double lat) {
-  if (lat < 0) lat = -lat;
-  if (lat < 10.4704713000) return 59;
-  if (lat < 14.8281743687) return 58;
-  if (lat < 18.1862635707) return 57;
-  if (lat < 21.0293949260) return 56;
-  if (lat < 23.5450448656) return 55;
-  if (lat < 25.8292470706) return 54;
-  if (lat < 27.9389871012) return 53;
-  if (lat < 29.9113568573) return 52;
-  if (lat < 31.7720970768) return 51;
-  if (lat < 33.5399343630) return 50;
-  if (lat < 35.2289959780) return 49;
-  if (lat < 36.8502510759) return 48;
-  if (lat < 38.4124189241) return 47;
-  if (lat < 39.9225668433) return 46;
-  if (lat < 41.3865183226) return 45;
-  if (lat < 42.8091401224) return 44;
-  if (lat < 44.1945495142) return 43;
-  if (lat < 45.5462672266) return 42;
-  if (lat < 46.8673325250) return 41;
-  if (lat < 48.1603912810) return 40;
-  if (lat < 49.4277643926) return 39;
-  if (lat < 50.6715016555) return 38;
-  if (lat < 51.8934246917) return 37;
-  if (lat < 53.0951615280) return 36;
-  if (lat < 54.2781747227) return 35;
-  if (lat < 55.4437844450) return 34;
-  if (lat < 56.5931875621) return 33;
-  if (lat < 57.7274735387) return 32;
-  if (lat < 58.8476377615) return 31;
-  if (lat < 59.9545927669) return 30;
-  if (lat < 61.0491777425) return 29;
-  if (lat < 62.1321665921) return 28;
-  if (lat < 63.2042747938) return 27;
-  if (lat < 64.2661652257) return 26;
-  if (lat < 65.3184530968) return 25;
-  if (lat < 66.3617100838) return 24;
-  if (lat < 67.3964677408) return 23;
-  if (lat < 68.4232202208) return 22;
-  if (lat < 69.4424263114) return 21;
-  if (lat < 70.4545107499) return 20;
-  if (lat < 71.4598647303) return 19;
-  if (lat < 72.4588454473) return 18;
-  if (lat < 73.4517744167) return 17;
-  if (lat < 74.4389341573) return 16;
-  if (lat < 75.4205625665) return 15;
-  if (lat < 76.3968439079) return 14;
-  if (lat < 77.3678946133) return 13;
-  if (lat < 78.3337408292) return 12;
-  if (lat < 79.2942822546) return 11;
-  if (lat < 80.2492321328) return 10;
-  if (lat < 81.1980134927) return 9;
-  if (lat < 82.1395698051) return 8;
-  if (lat < 83.0719944472) return 7;
-  if (lat < 83.9917356298) return 6;
-  if (lat < 84.8916619070) return 5;
-  if (lat < 85.7554162094) return 4;
-  if (lat < 86.5353699751) return 3;
-  if (lat < 87.0000000000)
-    return 2;
-  else
-    return 1;
-}
-
-double decode_lat_abs(std::array<unsigned char, 14> even_message,
-                      std::array<unsigned char, 14> odd_message) {
+  std::string callsign(8, ' ');
+  callsign[0] = char_map[frame.bits<41, 46>()];
+  callsign[1] = char_map[frame.bits<47, 52>()];
+  callsign[2] = char_map[frame.bits<53, 58>()];
+  callsign[3] = char_map[frame.bits<59, 64>()];
+  callsign[4] = char_map[frame.bits<65, 70>()];
+  callsign[5] = char_map[frame.bits<71, 76>()];
+  callsign[6] = char_map[frame.bits<77, 82>()];
+  callsign[7] = char_map[frame.bits<83, 88>()];
+  return callsign;
+}
+
+int decode_category(const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bits<38, 40>();
+}
+int decode_cpr_format(const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bit<54>();
+}
+
+double get_lat_cpr(const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bits<55, 71>() / 131072.0;
+}
+
+double get_lon_cpr(const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bits<72, 88>() / 131072.0;
+}
+
+double decode_lat_abs(const std::array<unsigned char, 14>& even_message,
+                      const std::array<unsigned char, 14>& odd_message) {
   double lat_cpr_even = get_lat_cpr(even_message);
   double lat_cpr_odd = get_lat_cpr(odd_message);
   int j = floor((59 * lat_cpr_even - 60 * lat_cpr_odd) + 0.5);
@@ -341,8 +506,8 @@ double decode_lat_abs(std::array<unsigned char, 14> even_message,
   return lat_even;
 }
 
-double decode_ground_lat_abs(std::array<unsigned char, 14> even_message,
-                             std::array<unsigned char, 14> odd_message) {
+double decode_ground_lat_abs(const std::array<unsigned char, 14>& even_message,
+                             const std::array<unsigned char, 14>& odd_message) {
   double lat_cpr_even = get_lat_cpr(even_message);
   double lat_cpr_odd = get_lat_cpr(odd_message);
   int j = floor((59 * lat_cpr_even - 60 * lat_cpr_odd) + 0.5);
@@ -356,8 +521,9 @@ double decode_ground_lat_abs(std::array<unsigned char, 14> even_message,
   return lat_even;
 }
 
-double decode_lon_abs(std::array<unsigned char, 14> even_message,
-                      std::array<unsigned char, 14> odd_message, double lat) {
+double decode_lon_abs(const std::array<unsigned char, 14>& even_message,
+                      const std::array<unsigned char, 14>& odd_message,
+                      double lat) {
   double lon_cpr_even = get_lon_cpr(even_message);
   double lon_cpr_odd = get_lon_cpr(odd_message);
   int NL_lat = compute_NL(lat);
@@ -380,8 +546,8 @@ double decode_lon_abs(std::array<unsigned char, 14> even_message,
   return lon;
 }
 
-double decode_ground_lon_abs(std::array<unsigned char, 14> even_message,
-                             std::array<unsigned char, 14> odd_message,
+double decode_ground_lon_abs(const std::array<unsigned char, 14>& even_message,
+                             const std::array<unsigned char, 14>& odd_message,
                              double lat) {
   double lon_cpr_even = get_lon_cpr(even_message);
   double lon_cpr_odd = get_lon_cpr(odd_message);
@@ -405,27 +571,25 @@ double decode_ground_lon_abs(std::array<unsigned char, 14> even_message,
   return lon;
 }
 
-int decode_barometric_altitude(std::array<unsigned char, 14> message,
+int decode_barometric_altitude(const std::array<unsigned char, 14>& message,
                                AltitudeType& altitude_type) {
-  int qbit = message[5] & 1;
-  int n = (message[5] & 254) << 3 | message[6] >> 4;
-  if (qbit) {
+  FrameView frame(message);
+  // the 12 bit altitude code lacks the M bit, Q is bit 48
+  int n = frame.bits<41, 47>() << 4 | frame.bits<49, 52>();
+  if (frame.bit<48>()) {
     altitude_type = BAROMETRIC_ALT;
     return 25 * n - 1000;
-  } else {
-    altitude_type = UNDETERMINED_ALT;
-    // TODO: implement Gray code (used for altitudes > 50175 ft)
-    return 0;
   }
+  // Gray code, used above 50175 ft
+  return decode_gillham_altitude(n, altitude_type);
 }
 
-int decode_gnss_altitude(std::array<unsigned char, 14> message,
+int decode_gnss_altitude(const std::array<unsigned char, 14>& message,
                          AltitudeType& altitude_type) {
-  int mbit = message[3] & (1 << 6);
-  int qbit = message[3] & (1 << 4);
-  if (!mbit && qbit) {
-    int n = ((message[2] & 31) << 6) | ((message[3] & 0x80) >> 2) |
-            ((message[3] & 0x20) >> 1) | (message[3] & 15);
+  FrameView frame(message);
+  if (!frame.bit<26>() && frame.bit<28>()) {
+    int n = frame.bits<20, 24>() << 6 | frame.bit<25>() << 5 |
+            frame.bit<27>() << 4 | frame.bits<29, 32>();
     altitude_type = GNSS_ALT;
     // convert to feet
     return round((25 * n - 1000) * 3.28084);
@@ -435,38 +599,40 @@ int decode_gnss_altitude(std::array<unsigned char, 14> message,
   }
 }
 
-int decode_tc19_subtype(std::array<unsigned char, 14> message) {
-  return message[4] & 3;
+int decode_tc19_subtype(const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bits<39, 40>();
 }
 
-BoolValue decode_intent_change_flag(std::array<unsigned char, 14> message) {
-  return (message[5] >> 7) ? TRUE : FALSE;
+BoolValue decode_intent_change_flag(
+    const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bit<41>() ? TRUE : FALSE;
 }
 
-BoolValue decode_ifr_capability_flag(std::array<unsigned char, 14> message) {
-  return ((message[5] >> 6) & 1) ? TRUE : FALSE;
+BoolValue decode_ifr_capability_flag(
+    const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bit<42>() ? TRUE : FALSE;
 }
 
-int decode_nav_uncertainty_category(std::array<unsigned char, 14> message) {
-  return (message[5] >> 3) & 7;
+int decode_nav_uncertainty_category(
+    const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bits<43, 45>();
 }
 
-double decode_magnetic_heading(std::array<unsigned char, 14> message) {
-  if (message[5] & (1 << 2)) {
-    int n = ((message[5] & 3) << 8) | message[6];
-    return n * 360.0 / 1024.0;
+double decode_magnetic_heading(const std::array<unsigned char, 14>& message) {
+  FrameView frame(message);
+  if (frame.bit<46>()) {
+    return frame.bits<47, 56>() * 360.0 / 1024.0;
   } else {
     return -1;
   }
 }
 
-SpeedType decode_speed_type(std::array<unsigned char, 14> message) {
+SpeedType decode_speed_type(const std::array<unsigned char, 14>& message) {
   int tc19_subtype = decode_tc19_subtype(message);
   if (tc19_subtype == 1 || tc19_subtype == 2) {
     return GROUND_SPEED;
   } else if (tc19_subtype == 3 || tc19_subtype == 4) {
-    int subtype34_airspeed_type = message[7] >> 7;
-    if (subtype34_airspeed_type) {
+    if (FrameView(message).bit<57>()) {
       return TRUE_AIRSPEED;
     } else {
       return INDICATED_AIRSPEED;
@@ -476,17 +642,17 @@ SpeedType decode_speed_type(std::array<unsigned char, 14> message) {
   }
 }
 
-double decode_airspeed(std::array<unsigned char, 14> message,
+double decode_airspeed(const std::array<unsigned char, 14>& message,
                        SpeedType& speed_type) {
-  int n = (message[7] & 127) << 3 | message[8] >> 5;
+  FrameView frame(message);
+  int n = frame.bits<58, 67>();
 
   if (n == 0) {
     speed_type = UNDETERMINED_SPEED;
     return 0;
   }
 
-  int subtype34_airspeed_type = message[7] >> 7;
-  if (subtype34_airspeed_type) {
+  if (frame.bit<57>()) {
     speed_type = TRUE_AIRSPEED;
   } else {
     speed_type = INDICATED_AIRSPEED;
@@ -502,65 +668,53 @@ double decode_airspeed(std::array<unsigned char, 14> message,
 }
 
 VerticalRateSource decode_vertical_rate_source(
-    std::array<unsigned char, 14> message) {
-  if ((message[8] >> 4) & 1) {
+    const std::array<unsigned char, 14>& message) {
+  if (FrameView(message).bit<68>()) {
     return BAROMETER;
   } else {
     return GNSS;
   }
 }
 
-int decode_vertical_rate(std::array<unsigned char, 14> message,
+int decode_vertical_rate(const std::array<unsigned char, 14>& message,
                          FieldStatus& vertical_rate_status) {
-  int n = (message[8] & 7) << 6 | message[9] >> 2;
+  FrameView frame(message);
+  int n = frame.bits<70, 78>();
   if (n == 0) {
     vertical_rate_status = UNDETERMINED;
     return 0;
   }
   vertical_rate_status = KNOWN;
-  if ((message[8] >> 3) & 1) {
+  if (frame.bit<69>()) {
     return (-64) * (n - 1);
   } else {
     return 64 * (n - 1);
-    ;
   }
 }
 
-int decode_altitude_delta(std::array<unsigned char, 14> message,
+int decode_altitude_delta(const std::array<unsigned char, 14>& message,
                           FieldStatus& altitude_delta_status) {
-  int n = (message[10] & 127);
+  FrameView frame(message);
+  int n = frame.bits<82, 88>();
   if (n == 0) {
     altitude_delta_status = UNDETERMINED;
     return 0;
   }
   altitude_delta_status = KNOWN;
-  if (message[10] >> 7) {
+  if (frame.bit<81>()) {
     return (-25) * (n - 1);
   } else {
     return 25 * (n - 1);
-    ;
   }
 }
 
-double decode_ground_speed(std::array<unsigned char, 14> message,
+double decode_ground_speed(const std::array<unsigned char, 14>& message,
                            SpeedType& speed_type) {
-  int sign_ew = (message[5] & 4) >> 2;
-  int n_ew = (message[5] & 3) << 8 | message[6];
-  int v_ew;
-  if (sign_ew) {
-    v_ew = (-1) * (n_ew - 1);
-  } else {
-    v_ew = (n_ew - 1);
-  }
-
-  int sign_ns = (message[7] >> 7);
-  int n_ns = (message[7] & 127) << 3 | message[8] >> 5;
-  int v_ns;
-  if (sign_ns) {
-    v_ns = (-1) * (n_ns - 1);
-  } else {
-    v_ns = (n_ns - 1);
-  }
+  FrameView frame(message);
+  int n_ew = frame.bits<47, 56>();
+  int v_ew = frame.bit<46>() ? (-1) * (n_ew - 1) : (n_ew - 1);
+  int n_ns = frame.bits<58, 67>();
+  int v_ns = frame.bit<57>() ? (-1) * (n_ns - 1) : (n_ns - 1);
   if (n_ew == 0 || n_ns == 0) {
     speed_type = UNDETERMINED_SPEED;
   }
@@ -568,32 +722,20 @@ double decode_ground_speed(std::array<unsigned char, 14> message,
   return sqrt(v_ns * v_ns + v_ew * v_ew);
 }
 
-double decode_track_angle(std::array<unsigned char, 14> message) {
-  int sign_ew = (message[5] & 4) >> 2;
-  int n_ew = (message[5] & 3) << 8 | message[6];
-  int v_ew;
-  if (sign_ew) {
-    v_ew = (-1) * (n_ew - 1);
-  } else {
-    v_ew = (n_ew - 1);
-  }
-
-  int sign_ns = (message[7] >> 7);
-  int n_ns = (message[7] & 127) << 3 | message[8] >> 5;
-  int v_ns;
-  if (sign_ns) {
-    v_ns = (-1) * (n_ns - 1);
-  } else {
-    v_ns = (n_ns - 1);
-  }
+double decode_track_angle(const std::array<unsigned char, 14>& message) {
+  FrameView frame(message);
+  int n_ew = frame.bits<47, 56>();
+  int v_ew = frame.bit<46>() ? (-1) * (n_ew - 1) : (n_ew - 1);
+  int n_ns = frame.bits<58, 67>();
+  int v_ns = frame.bit<57>() ? (-1) * (n_ns - 1) : (n_ns - 1);
   double track =
       std::fmod(atan2(v_ew, v_ns) * 360.0 / (2.0 * M_PI) + 360.0, 360.0);
   return track;
 }
 
-double decode_ground_movement(std::array<unsigned char, 14> message,
+double decode_ground_movement(const std::array<unsigned char, 14>& message,
                               SpeedType& speed_type) {
-  int encoded_speed = ((message[4] & 7) << 4) | (message[5] >> 4);
+  int encoded_speed = FrameView(message).bits<38, 44>();
   if (encoded_speed == 0) {
     speed_type = UNDETERMINED_SPEED;
     return -1;
@@ -627,16 +769,15 @@ double decode_ground_movement(std::array<unsigned char, 14> message,
   return -1;
 }
 
-int decode_ground_track_status(std::array<unsigned char, 14> message) {
-  return ((message[5] >> 3) & 1);
+int decode_ground_track_status(const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bit<45>();
 }
 
-double decode_ground_track(std::array<unsigned char, 14> message,
+double decode_ground_track(const std::array<unsigned char, 14>& message,
                            HeadingType& heading_type) {
   if (decode_ground_track_status(message)) {
     heading_type = GROUND_HEADING;
-    int n = ((message[5] & 7) << 4) | (message[6] >> 4);
-    return 360.0 * n / 128.0;
+    return 360.0 * FrameView(message).bits<46, 52>() / 128.0;
   } else {
     heading_type = UNDETERMINED_HEADING;
     return 0;
@@ -644,74 +785,174 @@ double decode_ground_track(std::array<unsigned char, 14> message,
 }
 
 SelectedAltitudeSource decode_selected_altitude_source(
-    std::array<unsigned char, 14> message) {
-  if (message[5] >> 7) {
+    const std::array<unsigned char, 14>& message) {
+  if (FrameView(message).bit<41>()) {
     return FMS;
   } else {
     return MCPFCU;
   }
 }
 
-BoolValue decode_autopilot(std::array<unsigned char, 14> message) {
-  if ((message[9] >> 1 & 1) == 0) {
+BoolValue decode_autopilot(const std::array<unsigned char, 14>& message) {
+  FrameView frame(message);
+  if (!frame.bit<79>()) {
     return UNDETERMINED_BOOL;
   }
-  return (message[9] & 1) ? TRUE : FALSE;
+  return frame.bit<80>() ? TRUE : FALSE;
 }
 
-BoolValue decode_lnav_mode(std::array<unsigned char, 14> message) {
-  if (!(message[9] >> 1 & 1)) {
+BoolValue decode_lnav_mode(const std::array<unsigned char, 14>& message) {
+  FrameView frame(message);
+  if (!frame.bit<79>()) {
     return UNDETERMINED_BOOL;
   }
-  return (message[10] & 32) ? TRUE : FALSE;
+  return frame.bit<83>() ? TRUE : FALSE;
 }
 
-BoolValue decode_vnav_mode(std::array<unsigned char, 14> message) {
-  if (!(message[9] >> 1 & 1)) {
+BoolValue decode_vnav_mode(const std::array<unsigned char, 14>& message) {
+  FrameView frame(message);
+  if (!frame.bit<79>()) {
     return UNDETERMINED_BOOL;
   }
-  return (message[10] >> 7) ? TRUE : FALSE;
+  return frame.bit<81>() ? TRUE : FALSE;
 }
-BoolValue decode_approach_mode(std::array<unsigned char, 14> message) {
-  if (!(message[9] >> 1 & 1)) {
+BoolValue decode_approach_mode(const std::array<unsigned char, 14>& message) {
+  FrameView frame(message);
+  if (!frame.bit<79>()) {
     return UNDETERMINED_BOOL;
   }
-  return ((message[10] >> 4) & 1) ? TRUE : FALSE;
+  return frame.bit<84>() ? TRUE : FALSE;
 }
-BoolValue decode_altitude_hold_mode(std::array<unsigned char, 14> message) {
-  if (!(message[9] >> 1 & 1)) {
+BoolValue decode_altitude_hold_mode(
+    const std::array<unsigned char, 14>& message) {
+  FrameView frame(message);
+  if (!frame.bit<79>()) {
     return UNDETERMINED_BOOL;
   }
-  return ((message[10] >> 6) & 1) ? TRUE : FALSE;
+  return frame.bit<82>() ? TRUE : FALSE;
 }
-BoolValue decode_tcas_operational(std::array<unsigned char, 14> message) {
-  int subtype = (message[4] >> 1) & 3;
-  if (subtype == 0) {
-    return (!((message[10] >> 4) & 1)) ? TRUE : FALSE;
+BoolValue decode_tcas_operational(
+    const std::array<unsigned char, 14>& message) {
+  FrameView frame(message);
+  if (frame.bits<38, 39>() == 0) {
+    return !frame.bit<84>() ? TRUE : FALSE;
   } else {
-    return ((message[10] >> 3) & 1) ? TRUE : FALSE;
+    return frame.bit<85>() ? TRUE : FALSE;
   }
 }
 
-double decode_baro_pressure_setting(std::array<unsigned char, 14> message) {
-  int pressure = ((message[6] & 15) << 5) | (message[7] >> 3);
+double decode_baro_pressure_setting(
+    const std::array<unsigned char, 14>& message) {
+  int pressure = FrameView(message).bits<53, 61>();
   return 800 + (pressure - 1) * 0.8;
 }
 
-int decode_selected_altitude(std::array<unsigned char, 14> message) {
-  int altitude = (message[5] & 127) << 4 | (message[6] >> 4);
+int decode_selected_altitude(const std::array<unsigned char, 14>& message) {
+  int altitude = FrameView(message).bits<42, 52>();
   return (altitude - 1) * 32;
 }
 
-double decode_selected_heading(std::array<unsigned char, 14> message,
+double decode_selected_heading(const std::array<unsigned char, 14>& message,
                                FieldStatus& selected_heading_status) {
-  if (((message[7] >> 2) & 1) == 0) {
+  FrameView frame(message);
+  if (!frame.bit<62>()) {
     selected_heading_status = UNDETERMINED;
     return 0.0;
   }
-  int heading = ((message[7] & 3) << 7) | (message[8] >> 1);
   selected_heading_status = KNOWN;
-  return (heading * (180.0 / 256.0));
+  return frame.bits<63, 71>() * (180.0 / 256.0);
+}
+
+int decode_target_altitude(const std::array<unsigned char, 14>& message,
+                           FieldStatus& target_altitude_status) {
+  FrameView frame(message);
+  int altitude = frame.bits<48, 57>() * 100 - 1000;
+  if (frame.bits<40, 41>() == 0 || altitude > 100000) {
+    target_altitude_status = UNDETERMINED;
+    return 0;
+  }
+  target_altitude_status = KNOWN;
+  return altitude;
+}
+
+SelectedAltitudeSource decode_target_altitude_source(
+    const std::array<unsigned char, 14>& message) {
+  switch (FrameView(message).bits<40, 41>()) {
+    case 1:
+    case 2:
+      // control panel or holding the current altitude
+      return MCPFCU;
+    case 3:
+      return FMS;
+    default:
+      return UNDETERMINED_SEL_ALT_SOURCE;
+  }
+}
+
+double decode_target_heading(const std::array<unsigned char, 14>& message,
+                             FieldStatus& target_heading_status) {
+  FrameView frame(message);
+  int heading = frame.bits<60, 68>();
+  if (frame.bits<58, 59>() == 0 || heading >= 360) {
+    target_heading_status = UNDETERMINED;
+    return 0.0;
+  }
+  target_heading_status = KNOWN;
+  return heading;
+}
+
+int decode_tc28_subtype(const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bits<38, 40>();
+}
+
+EmergencyState decode_emergency_state(
+    const std::array<unsigned char, 14>& message) {
+  FrameView frame(message);
+  if (frame.type_code() == 28 && frame.bits<38, 40>() == 1) {
+    return static_cast<EmergencyState>(frame.bits<41, 43>());
+  } else if (frame.type_code() == 29 && frame.bits<38, 39>() == 0) {
+    return static_cast<EmergencyState>(frame.bits<86, 88>());
+  }
+  return UNDETERMINED_EMERGENCY;
+}
+
+std::string decode_emergency_squawk(
+    const std::array<unsigned char, 14>& message) {
+  return id13_to_squawk(FrameView(message).bits<44, 56>());
+}
+
+int decode_acas_ra(const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bits<41, 54>();
+}
+
+int decode_acas_ra_complement(const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bits<55, 58>();
+}
+
+BoolValue decode_acas_ra_terminated(
+    const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bit<59>() ? TRUE : FALSE;
+}
+
+BoolValue decode_acas_multiple_threats(
+    const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bit<60>() ? TRUE : FALSE;
+}
+
+int decode_tc31_subtype(const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bits<38, 40>();
+}
+
+int decode_adsb_version(const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bits<73, 75>();
+}
+
+int decode_nac_p(const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bits<77, 80>();
+}
+
+int decode_sil(const std::array<unsigned char, 14>& message) {
+  return FrameView(message).bits<83, 84>();
 }
 
 std::string short_aircraft_category(int type_code, int category) {
@@ -937,3 +1178,46 @@ std::string bool_value_to_string(BoolValue value) {
       return "NA";
   }
 }
+
+std::string emergency_state_to_string(EmergencyState value) {
+  switch (value) {
+    case NO_EMERGENCY:
+      return "NONE";
+    case GENERAL_EMERGENCY:
+      return "GENERAL";
+    case LIFEGUARD_EMERGENCY:
+      return "LIFEGUARD";
+    case MINIMUM_FUEL:
+      return "MINIMUM_FUEL";
+    case NO_COMMUNICATIONS:
+      return "NO_COMMUNICATIONS";
+    case UNLAWFUL_INTERFERENCE:
+      return "UNLAWFUL_INTERFERENCE";
+    case DOWNED_AIRCRAFT:
+      return "DOWNED_AIRCRAFT";
+    case RESERVED_EMERGENCY:
+      return "RESERVED";
+    default:
+      return "UNDETERMINED";
+  }
+}
+
+// the 14 bit ARA field: bit 1 set for a single threat with bits 2-7 giving
+// corrective, downward sense, increased rate, sense reversal, crossing and
+// positive (climb/descend rather than a vertical speed limit)
+std::string acas_ra_to_string(int acas_ra, BoolValue multiple_threats) {
+  auto bit = [acas_ra](int n) { return (acas_ra >> (14 - n)) & 1; };
+  if (!bit(1)) {
+    return multiple_threats == TRUE ? "multiple threats" : "none";
+  }
+  std::string ra;
+  if (bit(4)) ra += "increase ";
+  if (bit(5)) ra += "reversal ";
+  if (bit(6)) ra += "crossing ";
+  if (bit(7)) {
+    ra += bit(3) ? "descend" : "climb";
+  } else {
+    ra += bit(3) ? "limit climb" : "limit descent";
+  }
+  return ra;
+}
@@ -3,6 +3,7 @@
 
 #include <array>
 #include <chrono>
+#include <cstdint>
 #include <string>
 
 enum HeadingType {
@@ -30,60 +31,127 @@ enum FieldStatus { KNOWN, UNDETERMINED };
 
 enum SelectedAltitudeSource { FMS, MCPFCU, UNDETERMINED_SEL_ALT_SOURCE };
 
-int decode_downlink_format(std::array<unsigned char, 14> message);
-int decode_capability(std::array<unsigned char, 14> message);
-std::string decode_icao(std::array<unsigned char, 14> message);
-int decode_msg_type(std::array<unsigned char, 14> message);
-std::string decode_callsign(std::array<unsigned char, 14> message);
-int decode_category(std::array<unsigned char, 14> message);
-
-int decode_cpr_format(std::array<unsigned char, 14> message);
-double get_lat_cpr(std::array<unsigned char, 14> message);
-double get_lon_cpr(std::array<unsigned char, 14> message);
-
-int compute_NL(double lat);
-double decode_lat_abs(std::array<unsigned char, 14> even_message,
-                      std::array<unsigned char, 14> odd_message);
-double decode_lon_abs(std::array<unsigned char, 14> even_message,
-                      std::array<unsigned char, 14> odd_message, double lat);
-int decode_barometric_altitude(std::array<unsigned char, 14> message,
+// emergency/priority status codes of TC28 subtype 1 and TC29 subtype 0
+enum EmergencyState {
+  NO_EMERGENCY,
+  GENERAL_EMERGENCY,
+  LIFEGUARD_EMERGENCY,
+  MINIMUM_FUEL,
+  NO_COMMUNICATIONS,
+  UNLAWFUL_INTERFERENCE,
+  DOWNED_AIRCRAFT,
+  RESERVED_EMERGENCY,
+  UNDETERMINED_EMERGENCY
+};
+
+enum CommBRegister {
+  BDS10,
+  BDS17,
+  BDS20,
+  BDS30,
+  BDS40,
+  BDS44,
+  BDS50,
+  BDS60,
+  UNKNOWN_BDS
+};
+
+int decode_downlink_format(const std::array<unsigned char, 14>& message);
+// 56 for the short formats DF0-15, 112 for the long ones
+int message_bits(int downlink_format);
+// replies whose parity field is overlaid with the address (DF0/4/5/16/20/21)
+bool has_address_parity(int downlink_format);
+// formats with a validated aircraft address, feeding the contact list
+bool is_tracked_format(int downlink_format);
+int decode_flight_status(const std::array<unsigned char, 14>& message);
+int decode_ac13_altitude(const std::array<unsigned char, 14>& message,
+                         AltitudeType& altitude_type);
+// altitude of the 11 bit Gillham code C1 A1 C2 A2 C4 A4 B1 B2 D2 B4 D4 that
+// remains of an altitude code with Q = 0 after dropping the M and Q bits
+int decode_gillham_altitude(int code, AltitudeType& altitude_type);
+std::string decode_squawk(const std::array<unsigned char, 14>& message);
+int decode_capability(const std::array<unsigned char, 14>& message);
+std::string decode_icao(const std::array<unsigned char, 14>& message);
+int decode_msg_type(const std::array<unsigned char, 14>& message);
+std::string decode_callsign(const std::array<unsigned char, 14>& message);
+int decode_category(const std::array<unsigned char, 14>& message);
+
+int decode_cpr_format(const std::array<unsigned char, 14>& message);
+double get_lat_cpr(const std::array<unsigned char, 14>& message);
+double get_lon_cpr(const std::array<unsigned char, 14>& message);
+
+double decode_lat_abs(const std::array<unsigned char, 14>& even_message,
+                      const std::array<unsigned char, 14>& odd_message);
+double decode_lon_abs(const std::array<unsigned char, 14>& even_message,
+                      const std::array<unsigned char, 14>& odd_message,
+                      double lat);
+int decode_barometric_altitude(const std::array<unsigned char, 14>& message,
                                AltitudeType& altitude_type);
-int decode_gnss_altitude(std::array<unsigned char, 14> message,
+int decode_gnss_altitude(const std::array<unsigned char, 14>& message,
                          AltitudeType& altitude_type);
-int decode_tc19_subtype(std::array<unsigned char, 14> message);
-BoolValue decode_intent_change_flag(std::array<unsigned char, 14> message);
-BoolValue decode_ifr_capability_flag(std::array<unsigned char, 14> message);
-int decode_nav_uncertainty_category(std::array<unsigned char, 14> message);
-double decode_magnetic_heading(std::array<unsigned char, 14> message);
-SpeedType decode_speed_type(std::array<unsigned char, 14> message);
-double decode_airspeed(std::array<unsigned char, 14> message,
+int decode_tc19_subtype(const std::array<unsigned char, 14>& message);
+BoolValue decode_intent_change_flag(
+    const std::array<unsigned char, 14>& message);
+BoolValue decode_ifr_capability_flag(
+    const std::array<unsigned char, 14>& message);
+int decode_nav_uncertainty_category(
+    const std::array<unsigned char, 14>& message);
+double decode_magnetic_heading(const std::array<unsigned char, 14>& message);
+SpeedType decode_speed_type(const std::array<unsigned char, 14>& message);
+double decode_airspeed(const std::array<unsigned char, 14>& message,
                        SpeedType& speed_type);
 VerticalRateSource decode_vertical_rate_source(
-    std::array<unsigned char, 14> message);
-int decode_vertical_rate(std::array<unsigned char, 14> message,
+    const std::array<unsigned char, 14>& message);
+int decode_vertical_rate(const std::array<unsigned char, 14>& message,
                          FieldStatus& vertical_rate_status);
-int decode_altitude_delta(std::array<unsigned char, 14> message,
+int decode_altitude_delta(const std::array<unsigned char, 14>& message,
                           FieldStatus& altitude_delta_status);
-double decode_ground_speed(std::array<unsigned char, 14> message,
+double decode_ground_speed(const std::array<unsigned char, 14>& message,
                            SpeedType& speed_type);
-double decode_track_angle(std::array<unsigned char, 14> message);
-double decode_ground_movement(std::array<unsigned char, 14> message,
+double decode_track_angle(const std::array<unsigned char, 14>& message);
+double decode_ground_movement(const std::array<unsigned char, 14>& message,
                               SpeedType& speed_type);
-int decode_ground_track_status(std::array<unsigned char, 14> message);
-double decode_ground_track(std::array<unsigned char, 14> message,
+int decode_ground_track_status(const std::array<unsigned char, 14>& message);
+double decode_ground_track(const std::array<unsigned char, 14>& message,
                            HeadingType& heading_type);
-BoolValue decode_autopilot(std::array<unsigned char, 14> message);
-BoolValue decode_lnav_mode(std::array<unsigned char, 14> message);
-BoolValue decode_vnav_mode(std::array<unsigned char, 14> message);
-BoolValue decode_approach_mode(std::array<unsigned char, 14> message);
-BoolValue decode_altitude_hold_mode(std::array<unsigned char, 14> message);
-BoolValue decode_tcas_operational(std::array<unsigned char, 14> message);
-double decode_baro_pressure_setting(std::array<unsigned char, 14> message);
-int decode_selected_altitude(std::array<unsigned char, 14> message);
+BoolValue decode_autopilot(const std::array<unsigned char, 14>& message);
+BoolValue decode_lnav_mode(const std::array<unsigned char, 14>& message);
+BoolValue decode_vnav_mode(const std::array<unsigned char, 14>& message);
+BoolValue decode_approach_mode(const std::array<unsigned char, 14>& message);
+BoolValue decode_altitude_hold_mode(
+    const std::array<unsigned char, 14>& message);
+BoolValue decode_tcas_operational(const std::array<unsigned char, 14>& message);
+double decode_baro_pressure_setting(
+    const std::array<unsigned char, 14>& message);
+int decode_selected_altitude(const std::array<unsigned char, 14>& message);
 SelectedAltitudeSource decode_selected_altitude_source(
-    std::array<unsigned char, 14> message);
-double decode_selected_heading(std::array<unsigned char, 14> message,
+    const std::array<unsigned char, 14>& message);
+double decode_selected_heading(const std::array<unsigned char, 14>& message,
                                FieldStatus& selected_heading_status);
+// target state of ADS-B version 1 (TC29 subtype 0)
+int decode_target_altitude(const std::array<unsigned char, 14>& message,
+                           FieldStatus& target_altitude_status);
+SelectedAltitudeSource decode_target_altitude_source(
+    const std::array<unsigned char, 14>& message);
+double decode_target_heading(const std::array<unsigned char, 14>& message,
+                             FieldStatus& target_heading_status);
+int decode_tc28_subtype(const std::array<unsigned char, 14>& message);
+EmergencyState decode_emergency_state(
+    const std::array<unsigned char, 14>& message);
+// Mode A code of TC28 subtype 1
+std::string decode_emergency_squawk(
+    const std::array<unsigned char, 14>& message);
+// resolution advisory of TC28 subtype 2, same bits in Comm-B register 3,0
+int decode_acas_ra(const std::array<unsigned char, 14>& message);
+int decode_acas_ra_complement(const std::array<unsigned char, 14>& message);
+BoolValue decode_acas_ra_terminated(
+    const std::array<unsigned char, 14>& message);
+BoolValue decode_acas_multiple_threats(
+    const std::array<unsigned char, 14>& message);
+int decode_tc31_subtype(const std::array<unsigned char, 14>& message);
+int decode_adsb_version(const std::array<unsigned char, 14>& message);
+int decode_nac_p(const std::array<unsigned char, 14>& message);
+int decode_sil(const std::array<unsigned char, 14>& message);
 std::string detailed_aircraft_category(int type_code, int category);
 std::string short_aircraft_category(int type_code, int category);
 std::string detailed_type_code(int type_code);
@@ -98,6 +166,9 @@ class ADSBMessage {
   int tc19_subtype = -1;
   std::string callsign = "";
   int aircraft_category = -1;
+  // surveillance and Comm-B replies (DF4/5/20/21)
+  int flight_status = -1;
+  std::string squawk = "";
 
   SpeedType speed_type = UNDETERMINED_SPEED;
   double speed = 0.0;
@@ -142,13 +213,46 @@ class ADSBMessage {
   FieldStatus baro_pressure_setting_status = UNDETERMINED;
   double baro_pressure_setting = -1;
 
+  EmergencyState emergency_state = UNDETERMINED_EMERGENCY;
+  FieldStatus acas_ra_status = UNDETERMINED;
+  int acas_ra = 0;
+  int acas_ra_complement = 0;
+  BoolValue acas_ra_terminated = UNDETERMINED_BOOL;
+  BoolValue acas_multiple_threats = UNDETERMINED_BOOL;
+
+  // operational status (TC31)
+  int adsb_version = -1;
+  int nac_p = -1;
+  int sil = -1;
+
+  // Comm-B register inferred from the MB field of DF20/21 replies
+  CommBRegister bds = UNKNOWN_BDS;
+  FieldStatus roll_angle_status = UNDETERMINED;
+  double roll_angle = 0.0;
+  FieldStatus true_airspeed_status = UNDETERMINED;
+  int true_airspeed = 0;
+  FieldStatus mach_status = UNDETERMINED;
+  double mach = 0.0;
+  FieldStatus magnetic_heading_status = UNDETERMINED;
+  double magnetic_heading = 0.0;
+
   std::chrono::system_clock::time_point timestamp;
+  // time of the preamble in 12 MHz ticks since the start of the stream
+  uint64_t timestamp_12mhz = 0;
+
+  // signal level and noise in dBFS, unknown for replayed demod files
+  FieldStatus signal_status = UNDETERMINED;
+  double rssi = 0.0;
+  double noise = 0.0;
 
   void init(std::array<unsigned char, 14> message,
             std::chrono::system_clock::time_point timestamp);
   ADSBMessage(std::array<unsigned char, 14> message);
   ADSBMessage(std::array<unsigned char, 14> message,
               std::chrono::system_clock::time_point timestamp);
+  ADSBMessage(std::array<unsigned char, 14> message,
+              std::chrono::system_clock::time_point timestamp,
+              uint64_t timestamp_12mhz);
   void PrintMessage();
   std::string HexString();
 };
@@ -160,5 +264,8 @@ std::string field_status_to_string(FieldStatus value);
 std::string selected_altitude_source_to_string(SelectedAltitudeSource value);
 std::string altitude_type_to_string(AltitudeType value);
 std::string bool_value_to_string(BoolValue value);
+std::string emergency_state_to_string(EmergencyState value);
+// sense of an active resolution advisory, e.g. "climb" or "crossing descend"
+std::string acas_ra_to_string(int acas_ra, BoolValue multiple_threats);
 
 #endif  // ADSBOOST_ADSB_MESSAGE_H_
\ No newline at end of file
@@ -3,6 +3,8 @@
 
 #include <gtest/gtest.h>
 
+#include <vector>
+
 #include "demodulator.h"
 
 class ADSBMessageTest : public ::testing::Test {
@@ -276,3 +278,165 @@ TEST_F(ADSBMessageTest, ADSBMessageTestDecodeStatus4) {
   EXPECT_NEAR(msg.selected_heading, 0, 1e-4);
   EXPECT_NEAR(msg.baro_pressure_setting, 1013.6, 1e-4);
 }
+
+// overlays the parity of a short reply with the aircraft address
+static void set_address_parity(std::array<unsigned char, 14> *message,
+                               uint32_t address) {
+  uint32_t parity = calc_crc(message, 56) ^ address;
+  (*message)[4] = (parity >> 16) & 0xFF;
+  (*message)[5] = (parity >> 8) & 0xFF;
+  (*message)[6] = parity & 0xFF;
+}
+
+TEST_F(ADSBMessageTest, ADSBMessageTestMessageBits) {
+  EXPECT_EQ(message_bits(0), 56);
+  EXPECT_EQ(message_bits(11), 56);
+  EXPECT_EQ(message_bits(16), 112);
+  EXPECT_EQ(message_bits(21), 112);
+}
+
+TEST_F(ADSBMessageTest, ADSBMessageTestDecodeAllCall) {
+  std::array<unsigned char, 14> message = {0x5d, 0x48, 0x40, 0xd6};
+  uint32_t parity = calc_crc(&message, 56);
+  message[4] = (parity >> 16) & 0xFF;
+  message[5] = (parity >> 8) & 0xFF;
+  message[6] = parity & 0xFF;
+  EXPECT_EQ(crc_syndrome(&message), 0);
+  ADSBMessage msg = ADSBMessage(message);
+  EXPECT_EQ(msg.downlink_format, 11);
+  EXPECT_EQ(msg.downlink_capability, 5);
+  EXPECT_EQ(msg.icao, "4840D6");
+  EXPECT_EQ(msg.type_code, -1);
+  EXPECT_EQ(msg.HexString().size(), 14);
+  EXPECT_EQ(msg.HexString().substr(0, 8), "5d4840d6");
+}
+
+TEST_F(ADSBMessageTest, ADSBMessageTestDecodeAltitudeReply) {
+  // DF4, airborne, 38000 ft in 25 ft steps
+  std::array<unsigned char, 14> message = {0x20, 0x00, 0x18, 0x38};
+  set_address_parity(&message, 0x3c6585);
+  ADSBMessage msg = ADSBMessage(message);
+  EXPECT_EQ(msg.downlink_format, 4);
+  EXPECT_EQ(msg.icao, "3C6585");
+  EXPECT_EQ(msg.flight_status, 0);
+  EXPECT_EQ(msg.altitude_type, BAROMETRIC_ALT);
+  EXPECT_EQ(msg.altitude, 38000);
+  EXPECT_EQ(msg.squawk, "");
+}
+
+TEST_F(ADSBMessageTest, ADSBMessageTestDecodeIdentityReply) {
+  // DF5, on the ground, squawk 7500
+  std::array<unsigned char, 14> message = {0x29, 0x00, 0x0a, 0xa2};
+  set_address_parity(&message, 0x4840d6);
+  ADSBMessage msg = ADSBMessage(message);
+  EXPECT_EQ(msg.downlink_format, 5);
+  EXPECT_EQ(msg.icao, "4840D6");
+  EXPECT_EQ(msg.flight_status, 1);
+  EXPECT_EQ(msg.squawk, "7500");
+  EXPECT_EQ(msg.altitude_type, UNDETERMINED_ALT);
+}
+
+TEST_F(ADSBMessageTest, ADSBMessageTestDecodeGrayAltitudeReply) {
+  // DF4, 2300 ft in Gillham code: C1 B1
+  std::array<unsigned char, 14> message = {0x20, 0x00, 0x10, 0x20};
+  set_address_parity(&message, 0x4840d6);
+  ADSBMessage msg = ADSBMessage(message);
+  EXPECT_EQ(msg.downlink_format, 4);
+  EXPECT_EQ(msg.altitude_type, BAROMETRIC_ALT);
+  EXPECT_EQ(msg.altitude, 2300);
+}
+
+TEST_F(ADSBMessageTest, ADSBMessageTestDecodeGrayAltitudePosition) {
+  // airborne position at 60000 ft, above the range of 25 ft steps
+  std::array<unsigned char, 14> message = {0x8d, 0x48, 0x40, 0xd6, 0x58,
+                                           0x22, 0xb2, 0xd6, 0x90, 0xc8,
+                                           0xac, 0x77, 0x7e, 0x4c};
+  EXPECT_EQ(true, check_crc(&message));
+  ADSBMessage msg = ADSBMessage(message);
+  EXPECT_EQ(msg.type_code, 11);
+  EXPECT_EQ(msg.altitude_type, BAROMETRIC_ALT);
+  EXPECT_EQ(msg.altitude, 60000);
+}
+
+TEST_F(ADSBMessageTest, ADSBMessageTestGillhamCodeIsGrayCode) {
+  // every altitude from -1200 ft to 126700 ft has exactly one code, and
+  // codes of adjacent altitudes differ in a single bit
+  std::vector<int> codes(1280, -1);
+  for (int code = 0; code < 2048; code++) {
+    AltitudeType altitude_type;
+    int altitude = decode_gillham_altitude(code, altitude_type);
+    if (altitude_type == UNDETERMINED_ALT) continue;
+    ASSERT_EQ(altitude % 100, 0);
+    int n = altitude / 100 + 12;
+    ASSERT_GE(n, 0);
+    ASSERT_LT(n, 1280);
+    EXPECT_EQ(codes[n], -1);
+    codes[n] = code;
+  }
+  for (int n = 1; n < 1280; n++) {
+    ASSERT_NE(codes[n], -1);
+    EXPECT_EQ(__builtin_popcount(codes[n] ^ codes[n - 1]), 1);
+  }
+}
+
+TEST_F(ADSBMessageTest, ADSBMessageTestDecodeEmergencyStatus) {
+  std::array<unsigned char, 14> message = {0x8d, 0x48, 0x40, 0xd6, 0xe1,
+                                           0x2a, 0xaa, 0x00, 0x00, 0x00,
+                                           0x00, 0x3c, 0xf5, 0xce};
+  EXPECT_EQ(true, check_crc(&message));
+  ADSBMessage msg = ADSBMessage(message);
+  EXPECT_EQ(msg.type_code, 28);
+  EXPECT_EQ(msg.emergency_state, GENERAL_EMERGENCY);
+  EXPECT_EQ(msg.squawk, "7700");
+  EXPECT_EQ(msg.acas_ra_status, UNDETERMINED);
+}
+
+TEST_F(ADSBMessageTest, ADSBMessageTestDecodeResolutionAdvisory) {
+  // single threat, corrective climb, threat identified by its address
+  std::array<unsigned char, 14> message = {0x8d, 0x48, 0x40, 0xd6, 0xe2,
+                                           0xc2, 0x00, 0x04, 0xf1, 0xb7,
+                                           0x44, 0x22, 0xbd, 0x62};
+  EXPECT_EQ(true, check_crc(&message));
+  ADSBMessage msg = ADSBMessage(message);
+  EXPECT_EQ(msg.type_code, 28);
+  EXPECT_EQ(msg.emergency_state, UNDETERMINED_EMERGENCY);
+  EXPECT_EQ(msg.acas_ra_status, KNOWN);
+  EXPECT_EQ(msg.acas_ra, 0x3080);
+  EXPECT_EQ(msg.acas_ra_complement, 0);
+  EXPECT_EQ(msg.acas_ra_terminated, FALSE);
+  EXPECT_EQ(msg.acas_multiple_threats, FALSE);
+  EXPECT_EQ(acas_ra_to_string(msg.acas_ra, msg.acas_multiple_threats),
+            "climb");
+  EXPECT_EQ(acas_ra_to_string(0x2000 | 0x100, FALSE), "crossing limit descent");
+  EXPECT_EQ(acas_ra_to_string(0, TRUE), "multiple threats");
+  EXPECT_EQ(acas_ra_to_string(0, FALSE), "none");
+}
+
+TEST_F(ADSBMessageTest, ADSBMessageTestDecodeTargetState) {
+  // ADS-B version 1: 35000 ft and 270 degrees from the control panel
+  std::array<unsigned char, 14> message = {0x8d, 0x48, 0x40, 0xd6, 0xe8,
+                                           0x84, 0xb4, 0x30, 0xe0, 0x00,
+                                           0x03, 0x99, 0xe6, 0x4d};
+  EXPECT_EQ(true, check_crc(&message));
+  ADSBMessage msg = ADSBMessage(message);
+  EXPECT_EQ(msg.type_code, 29);
+  EXPECT_EQ(msg.selected_altitude_status, KNOWN);
+  EXPECT_EQ(msg.selected_altitude, 35000);
+  EXPECT_EQ(msg.selected_altitude_source, MCPFCU);
+  EXPECT_EQ(msg.selected_heading_status, KNOWN);
+  EXPECT_EQ(msg.selected_heading, 270);
+  EXPECT_EQ(msg.emergency_state, MINIMUM_FUEL);
+  EXPECT_EQ(msg.tcas_operational, TRUE);
+}
+
+TEST_F(ADSBMessageTest, ADSBMessageTestDecodeOperationalStatus) {
+  std::array<unsigned char, 14> message = {0x8d, 0x48, 0x40, 0xd6, 0xf8,
+                                           0x00, 0x00, 0x00, 0x00, 0x4a,
+                                           0x30, 0xc8, 0x16, 0x90};
+  EXPECT_EQ(true, check_crc(&message));
+  ADSBMessage msg = ADSBMessage(message);
+  EXPECT_EQ(msg.type_code, 31);
+  EXPECT_EQ(msg.adsb_version, 2);
+  EXPECT_EQ(msg.nac_p, 10);
+  EXPECT_EQ(msg.sil, 3);
+}
@@ -0,0 +1,155 @@
+#include "batch.h"
+
+#include <sys/stat.h>
+
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <thread>
+
+void BatchReport::print(std::ostream &out) {
+  out << std::fixed << std::setprecision(2);
+  out << "Batch report" << std::endl;
+  out << "  threads:        " << n_threads << std::endl;
+  out << "  segments:       " << n_segments << std::endl;
+  out << "  messages:       " << n_messages << std::endl;
+  out << "  recording time: " << recording_seconds << " s" << std::endl;
+  out << "  wall time:      " << wall_seconds << " s";
+  if (wall_seconds > 0) {
+    out << " (" << recording_seconds / wall_seconds << "x real time)";
+  }
+  out << std::endl;
+  out << "  ";
+  stats.print(out);
+}
+
+std::vector<SampledMessage> process_segment(
+    const std::string &filename, uint64_t start, uint64_t end,
+    std::chrono::system_clock::time_point stream_start,
+    const DemodulatorSettings &settings,
+    std::shared_ptr<IcaoFilter> icao_filter, DemodulatorStats *stats) {
+  std::vector<SampledMessage> messages;
+  std::ifstream file(filename, std::ios::binary);
+  if (!file) {
+    std::cerr << "Cannot open file: " << filename << std::endl;
+    return messages;
+  }
+
+  // 256 KiB per buffer, too large for the stack of a worker thread
+  auto data =
+      std::make_unique<std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP>>();
+  data->fill(127);
+  uint64_t position = start;
+  if (start >= BUFFER_OVERLAP) {
+    file.seekg(start - BUFFER_OVERLAP);
+    file.read(reinterpret_cast<char *>(data->data()), BUFFER_OVERLAP);
+  } else {
+    file.seekg(start);
+  }
+
+  StreamClock stream_clock = {stream_start, settings.sample_rate};
+  Demodulator demodulator = Demodulator(settings, icao_filter);
+  std::vector<rawMessage> raw_messages;
+  while (position < end && file) {
+    size_t n_read = std::min<uint64_t>(BUFFER_LEN, end - position);
+    file.read(reinterpret_cast<char *>(data->data() + BUFFER_OVERLAP), n_read);
+    n_read = file.gcount();
+    if (n_read == 0) break;
+
+    // data->at(0) lies BUFFER_OVERLAP bytes before the current position
+    int64_t sample_offset = int64_t(position / 2) - BUFFER_OVERLAP / 2;
+    raw_messages.clear();
+    demodulator.Demodulate(data.get(), BUFFER_OVERLAP + n_read, sample_offset,
+                           &raw_messages);
+    for (const rawMessage &raw_message : raw_messages) {
+      messages.push_back({raw_message.sample_index,
+                          decode_raw_message(raw_message, stream_clock)});
+    }
+    position += n_read;
+    std::copy(data->begin() + n_read, data->begin() + n_read + BUFFER_OVERLAP,
+              data->begin());
+  }
+  *stats = demodulator.stats;
+  return messages;
+}
+
+BatchReport process_recording(const std::string &filename, int n_threads,
+                              uint64_t segment_len,
+                              const DemodulatorSettings &settings,
+                              std::vector<ADSBMessage> *messages) {
+  BatchReport report;
+  auto wall_start = std::chrono::steady_clock::now();
+
+  struct stat file_stat;
+  if (stat(filename.c_str(), &file_stat) != 0) {
+    std::cerr << "Cannot open file: " << filename << std::endl;
+    return report;
+  }
+  uint64_t file_len = file_stat.st_size;
+  // segment boundaries have to fall on whole IQ samples
+  segment_len = std::max<uint64_t>(segment_len - segment_len % 2, 2);
+  report.recording_seconds = file_len / 2.0 / settings.sample_rate;
+  report.n_segments = (file_len + segment_len - 1) / segment_len;
+  report.n_threads = std::max(1, n_threads);
+
+  // the recording is written while receiving, so it started one recording
+  // length before it was last modified
+  auto stream_start =
+      std::chrono::system_clock::from_time_t(file_stat.st_mtime) -
+      std::chrono::microseconds(file_len / 2 * 1000000 / settings.sample_rate);
+
+  // One filter of confirmed addresses for all segments, so that replies at the
+  // start of a segment are confirmed by frames of the preceding ones. The
+  // segments in flight span up to n_threads segments of stream time, which
+  // must not recycle each other's generations.
+  double segment_seconds = segment_len / 2.0 / settings.sample_rate;
+  auto icao_filter = std::make_shared<IcaoFilter>(
+      ICAO_FILTER_SECONDS + report.n_threads * segment_seconds);
+
+  std::vector<std::vector<SampledMessage>> results(report.n_segments);
+  std::vector<DemodulatorStats> stats(report.n_segments);
+  std::atomic<size_t> next_segment{0};
+  auto worker = [&]() {
+    for (size_t n = next_segment++; n < report.n_segments;
+         n = next_segment++) {
+      uint64_t start = n * segment_len;
+      uint64_t end = std::min(start + segment_len, file_len);
+      results[n] =
+          process_segment(filename, start, end, stream_start, settings,
+                          icao_filter, &stats[n]);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (int n = 0; n < report.n_threads; n++) {
+    threads.push_back(std::thread(worker));
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+
+  // Segments are ordered and each result is ordered by sample index, so they
+  // only need to be concatenated. Frames right at a segment boundary can be
+  // found by both neighbours and are dropped the second time.
+  for (const DemodulatorStats &segment_stats : stats) {
+    report.stats += segment_stats;
+  }
+  uint64_t last_sample_index = 0;
+  bool first = true;
+  for (const auto &segment : results) {
+    for (const SampledMessage &sampled : segment) {
+      if (!first && sampled.sample_index <= last_sample_index) {
+        continue;
+      }
+      first = false;
+      last_sample_index = sampled.sample_index;
+      messages->push_back(sampled.message);
+    }
+  }
+  report.n_messages = messages->size();
+  report.wall_seconds = std::chrono::duration<double>(
+                            std::chrono::steady_clock::now() - wall_start)
+                            .count();
+  return report;
+}
@@ -0,0 +1,51 @@
+#ifndef ADSBOOST_BATCH_H_
+#define ADSBOOST_BATCH_H_
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "adsb_message.h"
+#include "clock.h"
+#include "config.h"
+#include "demodulator.h"
+
+// default segment length in bytes of raw IQ data (~16 s at 2 MSPS)
+#define BATCH_SEGMENT_LEN 256 * (BUFFER_LEN)
+
+struct BatchReport {
+  int n_threads = 1;
+  size_t n_segments = 0;
+  size_t n_messages = 0;
+  double recording_seconds = 0;
+  double wall_seconds = 0;
+  DemodulatorStats stats;
+  void print(std::ostream &out);
+};
+
+struct SampledMessage {
+  uint64_t sample_index;
+  ADSBMessage message;
+};
+
+// Demodulates and decodes the bytes [start, end) of a raw IQ recording. The
+// preceding BUFFER_OVERLAP bytes are read as well, so that frames crossing the
+// segment start are found. Messages are ordered by sample index. Addresses
+// confirmed in other segments are shared through the icao_filter.
+std::vector<SampledMessage> process_segment(
+    const std::string &filename, uint64_t start, uint64_t end,
+    std::chrono::system_clock::time_point stream_start,
+    const DemodulatorSettings &settings,
+    std::shared_ptr<IcaoFilter> icao_filter, DemodulatorStats *stats);
+
+// Splits a raw IQ recording into segments which are processed on n_threads
+// threads and merges the decoded messages by absolute sample time.
+BatchReport process_recording(const std::string &filename, int n_threads,
+                              uint64_t segment_len,
+                              const DemodulatorSettings &settings,
+                              std::vector<ADSBMessage> *messages);
+
+#endif  // ADSBOOST_BATCH_H_
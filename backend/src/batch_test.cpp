@@ -0,0 +1,81 @@
+#include "batch.h"
+
+#include <gtest/gtest.h>
+
+#include "crc.h"
+#include "test/test_signal.h"
+
+class BatchTest : public ::testing::Test {
+ protected:
+  BatchTest() {}
+  std::array<unsigned char, 14> frame_1 = {0x8d, 0x3c, 0x65, 0x85, 0x23,
+                                           0x10, 0xc2, 0x34, 0x04, 0x88,
+                                           0x20, 0x5a, 0x8f, 0xaf};
+  std::array<unsigned char, 14> frame_2 = {0x8d, 0x4d, 0x24, 0x14, 0x58,
+                                           0xc3, 0x93, 0xbc, 0x05, 0xfd,
+                                           0x7f, 0xf0, 0x81, 0x1e};
+};
+
+TEST_F(BatchTest, ProcessRecordingMergesSegments) {
+  std::string filename = testing::TempDir() + "batch_test_iq.bin";
+  // 4 segments of 100000 samples, frames well inside, across the first
+  // segment boundary and within the last BUFFER_OVERLAP of a segment
+  uint64_t segment_len = 200000;
+  std::vector<unsigned char> iq = silent_iq(400000);
+  std::vector<size_t> frame_samples = {1000, 99950, 100000 - 300, 150000,
+                                       299900, 350000};
+  std::sort(frame_samples.begin(), frame_samples.end());
+  for (size_t n = 0; n < frame_samples.size(); n++) {
+    modulate_frame(&iq, frame_samples[n], (n % 2) ? frame_2 : frame_1);
+  }
+  // overlapping frames would not be decodable
+  ASSERT_GE(frame_samples[2] - frame_samples[1], 240);
+  write_iq_file(filename, iq);
+
+  for (int n_threads : {1, 3}) {
+    std::vector<ADSBMessage> messages;
+    BatchReport report =
+        process_recording(filename, n_threads, segment_len,
+                          DemodulatorSettings(), &messages);
+    EXPECT_EQ(report.n_segments, 4);
+    EXPECT_NEAR(report.recording_seconds, 0.2, 1e-9);
+    ASSERT_EQ(messages.size(), frame_samples.size());
+    for (size_t n = 0; n < messages.size(); n++) {
+      EXPECT_EQ(messages[n].message, (n % 2) ? frame_2 : frame_1);
+    }
+    // timestamps follow the sample position
+    auto delta = std::chrono::duration_cast<std::chrono::microseconds>(
+                     messages.back().timestamp - messages.front().timestamp)
+                     .count();
+    EXPECT_EQ(delta, (frame_samples.back() - frame_samples.front()) / 2);
+  }
+}
+
+TEST_F(BatchTest, ShortRepliesAfterSegmentBoundary) {
+  std::string filename = testing::TempDir() + "batch_test_short_iq.bin";
+  uint64_t segment_len = 200000;
+  std::vector<unsigned char> iq = silent_iq(200000);
+  modulate_frame(&iq, 1000, frame_1);
+  // altitude reply with address parity of frame_1, early in the second segment
+  std::array<unsigned char, 14> reply = {0x20, 0x00, 0x18, 0x38};
+  uint32_t parity = calc_crc(&reply, 56) ^ 0x3c6585;
+  reply[4] = (parity >> 16) & 0xFF;
+  reply[5] = (parity >> 8) & 0xFF;
+  reply[6] = parity & 0xFF;
+  modulate_frame(&iq, 102000, reply, 100, 56);
+  write_iq_file(filename, iq);
+
+  std::vector<ADSBMessage> one_pass;
+  process_recording(filename, 1, iq.size(), DemodulatorSettings(), &one_pass);
+  ASSERT_EQ(one_pass.size(), 2);
+  // one thread processes the segments in stream order
+  std::vector<ADSBMessage> messages;
+  BatchReport report = process_recording(filename, 1, segment_len,
+                                         DemodulatorSettings(), &messages);
+  EXPECT_EQ(report.n_segments, 2);
+  ASSERT_EQ(messages.size(), one_pass.size());
+  for (size_t n = 0; n < messages.size(); n++) {
+    EXPECT_EQ(messages[n].message, one_pass[n].message);
+    EXPECT_EQ(messages[n].timestamp, one_pass[n].timestamp);
+  }
+}
@@ -0,0 +1,26 @@
+#include <fstream>
+#include <iostream>
+
+#include "registry.h"
+
+// Builds the registry file for ads-boost --registry from an aircraft CSV,
+// e.g. the OpenSky aircraft database.
+int main(int argc, char **argv) {
+  if (argc != 3) {
+    std::cout << "Usage: build-registry <aircraft.csv> <registry.bin>"
+              << std::endl;
+    return 1;
+  }
+  std::ifstream csv(argv[1]);
+  if (!csv) {
+    std::cout << "Cannot open " << argv[1] << std::endl;
+    return 1;
+  }
+  long n_records = build_registry(csv, argv[2]);
+  if (n_records < 0) {
+    return 1;
+  }
+  std::cout << "Wrote " << n_records << " aircraft to " << argv[2]
+            << std::endl;
+  return 0;
+}
@@ -0,0 +1,40 @@
+#include "clock.h"
+
+std::chrono::system_clock::time_point SystemClock::now() {
+  return std::chrono::system_clock::now();
+}
+
+std::chrono::system_clock::time_point VirtualClock::now() {
+  return std::chrono::system_clock::time_point(
+      std::chrono::microseconds(now_us.load()));
+}
+
+void VirtualClock::advance(std::chrono::system_clock::time_point timestamp) {
+  int64_t timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                             timestamp.time_since_epoch())
+                             .count();
+  int64_t current = now_us.load();
+  while (timestamp_us > current &&
+         !now_us.compare_exchange_weak(current, timestamp_us)) {
+  }
+}
+
+uint64_t StreamClock::to_ticks(uint64_t sample_index) const {
+  // split to avoid overflowing for long streams
+  return sample_index / sample_rate * 12000000 +
+         sample_index % sample_rate * 12000000 / sample_rate;
+}
+
+std::chrono::system_clock::time_point StreamClock::to_time(
+    uint64_t sample_index) const {
+  uint64_t ticks = to_ticks(sample_index);
+  return start + std::chrono::duration_cast<
+                     std::chrono::system_clock::duration>(
+                     std::chrono::nanoseconds(ticks / 12 * 1000 +
+                                              ticks % 12 * 1000 / 12));
+}
+
+Clock* default_clock() {
+  static SystemClock clock;
+  return &clock;
+}
@@ -0,0 +1,42 @@
+#ifndef ADSBOOST_CLOCK_H_
+#define ADSBOOST_CLOCK_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+class Clock {
+ public:
+  virtual ~Clock() = default;
+  virtual std::chrono::system_clock::time_point now() = 0;
+};
+
+class SystemClock : public Clock {
+ public:
+  std::chrono::system_clock::time_point now() override;
+};
+
+// Clock driven by the timestamps of replayed messages. It only moves forward,
+// so out-of-order timestamps do not make contacts look younger.
+class VirtualClock : public Clock {
+ public:
+  std::chrono::system_clock::time_point now() override;
+  void advance(std::chrono::system_clock::time_point timestamp);
+
+ private:
+  std::atomic<int64_t> now_us{0};
+};
+
+// Converts absolute sample indices of a sample stream to a 12 MHz tick count
+// and to wall-clock time, anchored at the time of the first sample.
+struct StreamClock {
+  std::chrono::system_clock::time_point start;
+  int sample_rate = 2000000;
+
+  uint64_t to_ticks(uint64_t sample_index) const;
+  std::chrono::system_clock::time_point to_time(uint64_t sample_index) const;
+};
+
+Clock* default_clock();
+
+#endif  // ADSBOOST_CLOCK_H_
@@ -0,0 +1,289 @@
+#include "comm_b.h"
+
+#include <cmath>
+
+#include "frame_view.h"
+
+namespace {
+
+constexpr uint64_t field_mask(int first, int last) {
+  return ((uint64_t{1} << (last - first + 1)) - 1) << (56 - last);
+}
+
+// MB bits first to last (1-indexed, inclusive)
+uint32_t bits(uint64_t mb, int first, int last) {
+  return (mb >> (56 - last)) & ((uint64_t{1} << (last - first + 1)) - 1);
+}
+
+// sign bit followed by the two's complement bits first to last
+int signed_bits(uint64_t mb, int sign, int first, int last) {
+  int value = bits(mb, first, last);
+  return bits(mb, sign, sign) ? value - (1 << (last - first + 1)) : value;
+}
+
+struct StatusField {
+  uint64_t status;
+  uint64_t field;
+};
+
+constexpr StatusField status_field(int status_bit, int first, int last) {
+  return {field_mask(status_bit, status_bit), field_mask(first, last)};
+}
+
+struct RegisterLayout {
+  CommBRegister bds;
+  // fixed register number in MB bits 1-8, -1 if there is none
+  int identifier;
+  uint64_t reserved;
+  // fields that have to be zero if their status bit is not set
+  std::array<StatusField, 5> fields;
+};
+
+constexpr std::array<RegisterLayout, UNKNOWN_BDS> layouts = {{
+    {BDS10, 0x10, field_mask(10, 14), {}},
+    {BDS17, -1, field_mask(29, 56), {}},
+    {BDS20, 0x20, 0, {}},
+    {BDS30, 0x30, 0, {}},
+    {BDS40,
+     -1,
+     field_mask(40, 47) | field_mask(52, 53),
+     {{status_field(1, 2, 13), status_field(14, 15, 26),
+       status_field(27, 28, 39), status_field(48, 49, 51),
+       status_field(54, 55, 56)}}},
+    {BDS44,
+     -1,
+     0,
+     {{status_field(5, 6, 23), status_field(35, 36, 46),
+       status_field(47, 48, 49), status_field(50, 51, 56)}}},
+    {BDS50,
+     -1,
+     0,
+     {{status_field(1, 2, 11), status_field(12, 13, 23),
+       status_field(24, 25, 34), status_field(35, 36, 45),
+       status_field(46, 47, 56)}}},
+    {BDS60,
+     -1,
+     0,
+     {{status_field(1, 2, 12), status_field(13, 14, 23),
+       status_field(24, 25, 34), status_field(35, 36, 45),
+       status_field(46, 47, 56)}}},
+}};
+
+bool status(uint64_t mb, int status_bit) {
+  return bits(mb, status_bit, status_bit);
+}
+
+// BDS 5,0 track and turn report
+double roll_angle50(uint64_t mb) {
+  return signed_bits(mb, 2, 3, 11) * 45.0 / 256.0;
+}
+int ground_speed50(uint64_t mb) { return bits(mb, 25, 34) * 2; }
+double track_rate50(uint64_t mb) {
+  return signed_bits(mb, 36, 37, 45) * 8.0 / 256.0;
+}
+int true_airspeed50(uint64_t mb) { return bits(mb, 47, 56) * 2; }
+
+// BDS 6,0 heading and speed report
+double magnetic_heading60(uint64_t mb) {
+  double heading = signed_bits(mb, 2, 3, 12) * 90.0 / 512.0;
+  return heading < 0 ? heading + 360.0 : heading;
+}
+int indicated_airspeed60(uint64_t mb) { return bits(mb, 14, 23); }
+double mach60(uint64_t mb) { return bits(mb, 25, 34) * 2.048 / 512.0; }
+int vertical_rate60(uint64_t mb, int sign) {
+  return signed_bits(mb, sign, sign + 1, sign + 9) * 32;
+}
+
+bool plausible(CommBRegister bds, const std::array<unsigned char, 14> &message,
+               uint64_t mb) {
+  switch (bds) {
+    case BDS17:
+      // a transponder reporting registers at all supports BDS 2,0
+      return status(mb, 7);
+    case BDS20:
+      return decode_callsign(message).find('#') == std::string::npos;
+    case BDS30:
+      // threat type indicator 3 is not assigned
+      return bits(mb, 29, 30) != 3;
+    case BDS40:
+      return !(status(mb, 1) && bits(mb, 2, 13) * 16 > 50000) &&
+             !(status(mb, 14) && bits(mb, 15, 26) * 16 > 50000);
+    case BDS44: {
+      double temperature = signed_bits(mb, 24, 25, 34) * 0.25;
+      return bits(mb, 1, 4) <= 4 && bits(mb, 6, 14) <= 250 &&
+             temperature >= -80 && temperature <= 60;
+    }
+    case BDS50: {
+      if (status(mb, 1) && std::abs(roll_angle50(mb)) > 50) return false;
+      if (status(mb, 24) && ground_speed50(mb) > 600) return false;
+      if (status(mb, 35) && std::abs(track_rate50(mb)) > 10) return false;
+      if (status(mb, 46) && true_airspeed50(mb) > 500) return false;
+      if (status(mb, 24) && status(mb, 46) &&
+          std::abs(ground_speed50(mb) - true_airspeed50(mb)) > 200) {
+        return false;
+      }
+      return true;
+    }
+    case BDS60: {
+      int ias = indicated_airspeed60(mb);
+      double mach = mach60(mb);
+      if (status(mb, 13) && (ias == 0 || ias > 500)) return false;
+      if (status(mb, 24) && (mach == 0 || mach > 1)) return false;
+      if (status(mb, 35) && std::abs(vertical_rate60(mb, 36)) > 6000) {
+        return false;
+      }
+      if (status(mb, 46) && std::abs(vertical_rate60(mb, 47)) > 6000) {
+        return false;
+      }
+      // ratio of IAS to Mach drops from ~660 kt at sea level with altitude
+      if (status(mb, 13) && status(mb, 24) &&
+          (ias / mach < 200 || ias / mach > 700)) {
+        return false;
+      }
+      return true;
+    }
+    default:
+      return true;
+  }
+}
+
+}  // namespace
+
+uint64_t comm_b_field(const std::array<unsigned char, 14> &message) {
+  FrameView frame(message);
+  return uint64_t{frame.bits<33, 60>()} << 28 | frame.bits<61, 88>();
+}
+
+uint32_t comm_b_candidates(uint64_t mb) {
+  uint32_t candidates = 0;
+  if (mb == 0) {
+    return candidates;
+  }
+  for (const RegisterLayout &layout : layouts) {
+    if (layout.identifier >= 0 &&
+        bits(mb, 1, 8) != static_cast<uint32_t>(layout.identifier)) {
+      continue;
+    }
+    if (mb & layout.reserved) {
+      continue;
+    }
+    bool consistent = true;
+    uint64_t status_bits = 0;
+    for (const StatusField &field : layout.fields) {
+      if (field.status == 0) {
+        break;
+      }
+      if (!(mb & field.status) && (mb & field.field)) {
+        consistent = false;
+        break;
+      }
+      status_bits |= mb & field.status;
+    }
+    // registers with status bits have to report at least one field
+    if (!consistent || (layout.fields[0].status != 0 && status_bits == 0)) {
+      continue;
+    }
+    candidates |= 1u << layout.bds;
+  }
+  return candidates;
+}
+
+CommBRegister infer_bds(const std::array<unsigned char, 14> &message) {
+  uint64_t mb = comm_b_field(message);
+  uint32_t candidates = comm_b_candidates(mb);
+  CommBRegister inferred = UNKNOWN_BDS;
+  for (int bds = 0; bds < UNKNOWN_BDS; bds++) {
+    if (!(candidates >> bds & 1) ||
+        !plausible(static_cast<CommBRegister>(bds), message, mb)) {
+      continue;
+    }
+    if (inferred != UNKNOWN_BDS) {
+      // ambiguous
+      return UNKNOWN_BDS;
+    }
+    inferred = static_cast<CommBRegister>(bds);
+  }
+  return inferred;
+}
+
+void decode_comm_b(ADSBMessage *message) {
+  if (message->downlink_format != 20 && message->downlink_format != 21) {
+    return;
+  }
+  message->bds = infer_bds(message->message);
+  uint64_t mb = comm_b_field(message->message);
+  switch (message->bds) {
+    case BDS20:
+      message->callsign = decode_callsign(message->message);
+      break;
+    case BDS30:
+      // ACAS resolution advisory, same bits as in TC28 subtype 2
+      message->acas_ra = decode_acas_ra(message->message);
+      message->acas_ra_complement = decode_acas_ra_complement(message->message);
+      message->acas_ra_terminated = decode_acas_ra_terminated(message->message);
+      message->acas_multiple_threats =
+          decode_acas_multiple_threats(message->message);
+      message->acas_ra_status = KNOWN;
+      break;
+    case BDS40:
+      if (status(mb, 1)) {
+        message->selected_altitude = bits(mb, 2, 13) * 16;
+        message->selected_altitude_source = MCPFCU;
+        message->selected_altitude_status = KNOWN;
+      } else if (status(mb, 14)) {
+        message->selected_altitude = bits(mb, 15, 26) * 16;
+        message->selected_altitude_source = FMS;
+        message->selected_altitude_status = KNOWN;
+      }
+      if (status(mb, 27)) {
+        message->baro_pressure_setting = bits(mb, 28, 39) * 0.1 + 800.0;
+        message->baro_pressure_setting_status = KNOWN;
+      }
+      break;
+    case BDS50:
+      if (status(mb, 1)) {
+        message->roll_angle = roll_angle50(mb);
+        message->roll_angle_status = KNOWN;
+      }
+      if (status(mb, 46)) {
+        message->true_airspeed = true_airspeed50(mb);
+        message->true_airspeed_status = KNOWN;
+      }
+      break;
+    case BDS60:
+      if (status(mb, 1)) {
+        message->magnetic_heading = magnetic_heading60(mb);
+        message->magnetic_heading_status = KNOWN;
+      }
+      if (status(mb, 24)) {
+        message->mach = mach60(mb);
+        message->mach_status = KNOWN;
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+std::string bds_to_string(CommBRegister value) {
+  switch (value) {
+    case BDS10:
+      return "1,0";
+    case BDS17:
+      return "1,7";
+    case BDS20:
+      return "2,0";
+    case BDS30:
+      return "3,0";
+    case BDS40:
+      return "4,0";
+    case BDS44:
+      return "4,4";
+    case BDS50:
+      return "5,0";
+    case BDS60:
+      return "6,0";
+    default:
+      return "UNDETERMINED";
+  }
+}
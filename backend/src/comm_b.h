@@ -0,0 +1,22 @@
+#ifndef ADSBOOST_COMM_B_H_
+#define ADSBOOST_COMM_B_H_
+
+#include <array>
+#include <cstdint>
+
+#include "adsb_message.h"
+
+// 56 bit MB field of a DF20/21 reply, MB bit 1 is bit 55 of the result
+uint64_t comm_b_field(const std::array<unsigned char, 14>& message);
+// registers whose reserved and status bits are consistent with the MB field,
+// as a bit mask over CommBRegister
+uint32_t comm_b_candidates(uint64_t mb);
+// the single register that passes the status bit check and the plausibility
+// checks of its decoded values, UNKNOWN_BDS if none or several do
+CommBRegister infer_bds(const std::array<unsigned char, 14>& message);
+// infers the register of a DF20/21 reply and decodes it into the message
+void decode_comm_b(ADSBMessage *message);
+
+std::string bds_to_string(CommBRegister value);
+
+#endif  // ADSBOOST_COMM_B_H_
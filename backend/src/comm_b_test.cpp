@@ -0,0 +1,76 @@
+#include "comm_b.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "adsb_message.h"
+
+class CommBTest : public ::testing::Test {
+ protected:
+  CommBTest() {}
+};
+
+static std::array<unsigned char, 14> from_hex(std::string hex) {
+  std::array<unsigned char, 14> message = {};
+  for (size_t n = 0; n < message.size(); n++) {
+    message[n] = std::stoi(hex.substr(2 * n, 2), nullptr, 16);
+  }
+  return message;
+}
+
+TEST_F(CommBTest, CheckInferRegister) {
+  EXPECT_EQ(infer_bds(from_hex("A800178D10010080F50000D5893C")), BDS10);
+  EXPECT_EQ(infer_bds(from_hex("A0000638FA81C10000000081A92F")), BDS17);
+  EXPECT_EQ(infer_bds(from_hex("A000083E202CC371C31DE0AA1CCF")), BDS20);
+  EXPECT_EQ(infer_bds(from_hex("A000029C85E42F313000007047D3")), BDS40);
+  EXPECT_EQ(infer_bds(from_hex("A0001692185BD5CF400000DFC696")), BDS44);
+  EXPECT_EQ(infer_bds(from_hex("A000139381951536E024D4CCF6B5")), BDS50);
+  EXPECT_EQ(infer_bds(from_hex("A00004128F39F91A7E27C46ADC21")), BDS60);
+}
+
+TEST_F(CommBTest, CheckStatusBitCandidates) {
+  EXPECT_EQ(comm_b_candidates(0), 0);
+  // the status bit of the MCP/FCU selected altitude is not set
+  uint64_t mb = comm_b_field(from_hex("A000029C85E42F313000007047D3"));
+  EXPECT_TRUE(comm_b_candidates(mb) >> BDS40 & 1);
+  EXPECT_FALSE(comm_b_candidates(mb & ~(uint64_t{1} << 55)) >> BDS40 & 1);
+}
+
+TEST_F(CommBTest, CheckDecodeIdentification) {
+  ADSBMessage msg = ADSBMessage(from_hex("A000083E202CC371C31DE0AA1CCF"));
+  EXPECT_EQ(msg.downlink_format, 20);
+  EXPECT_EQ(msg.bds, BDS20);
+  EXPECT_EQ(msg.callsign, "KLM1017 ");
+}
+
+TEST_F(CommBTest, CheckDecodeSelectedVerticalIntention) {
+  ADSBMessage msg = ADSBMessage(from_hex("A000029C85E42F313000007047D3"));
+  EXPECT_EQ(msg.bds, BDS40);
+  EXPECT_EQ(msg.selected_altitude_status, KNOWN);
+  EXPECT_EQ(msg.selected_altitude, 3008);
+  EXPECT_EQ(msg.selected_altitude_source, MCPFCU);
+  EXPECT_NEAR(msg.baro_pressure_setting, 1020.0, 1e-4);
+}
+
+TEST_F(CommBTest, CheckDecodeTrackAndTurn) {
+  ADSBMessage msg = ADSBMessage(from_hex("A000139381951536E024D4CCF6B5"));
+  EXPECT_EQ(msg.bds, BDS50);
+  EXPECT_EQ(msg.roll_angle_status, KNOWN);
+  EXPECT_NEAR(msg.roll_angle, 2.1, 0.01);
+  EXPECT_EQ(msg.true_airspeed_status, KNOWN);
+  EXPECT_EQ(msg.true_airspeed, 424);
+
+  msg = ADSBMessage(from_hex("A0001691FFD263377FFCE02B2BF9"));
+  EXPECT_EQ(msg.bds, BDS50);
+  EXPECT_NEAR(msg.roll_angle, -0.35, 0.01);
+}
+
+TEST_F(CommBTest, CheckDecodeHeadingAndSpeed) {
+  ADSBMessage msg = ADSBMessage(from_hex("A00004128F39F91A7E27C46ADC21"));
+  EXPECT_EQ(msg.bds, BDS60);
+  EXPECT_EQ(msg.magnetic_heading_status, KNOWN);
+  EXPECT_NEAR(msg.magnetic_heading, 42.71, 0.01);
+  EXPECT_EQ(msg.mach_status, KNOWN);
+  EXPECT_NEAR(msg.mach, 0.42, 1e-4);
+}
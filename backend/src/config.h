@@ -2,6 +2,38 @@
 #define ADSBOOST_CONFIG_H_
 
 #define BUFFER_LEN 16 * 16384
-#define BUFFER_OVERLAP 480
+// one full frame (120 us) at the highest supported sample rate of 8 MSPS
+#define BUFFER_OVERLAP 1920
+#define SAMPLE_RATE 2000000
+
+// preamble candidates have to be this many dB above the noise floor
+#define PREAMBLE_THRESHOLD_DB 3.0
+
+// every n-th sample is used to estimate DC offset and I/Q gain imbalance
+#define IQ_ESTIMATE_STRIDE 16
+
+// seconds an address confirmed by DF11/17/18 validates address/parity replies
+#define ICAO_FILTER_SECONDS 60
+
+// least confident bits tried to repair a frame failing the CRC check, by
+// default and at most
+#define CORRECTED_BITS 2
+#define MAX_CORRECTED_BITS 8
+
+// recorded time covered by one step when replaying demodulated messages
+#define REPLAY_SLICE_MS 100
+
+// partitions of the contact list, each updated under its own lock
+#define CONTACT_SHARDS 16
+
+// track history per contact: ring capacity in samples, and a new position is
+// only kept when the aircraft moved or turned this far or after this interval
+#define TRACK_HISTORY_CAPACITY 256
+#define TRACK_MIN_DISTANCE_NM 0.5
+#define TRACK_MIN_TURN_DEG 10.0
+#define TRACK_MAX_INTERVAL_S 60
+
+// seconds between snapshots of the contact list for warm restarts
+#define SNAPSHOT_INTERVAL_S 10
 
 #endif  // ADSBOOST_CONFIG_H_
\ No newline at end of file
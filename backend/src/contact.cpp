@@ -1,6 +1,8 @@
 #include "contact.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <iomanip>
 #include <iostream>
 #include <sstream>
@@ -15,24 +17,143 @@ ContactList::ContactList(int timeout, double lat_ref, double lon_ref) {
 };
 
 std::list<Contact>* ContactList::get_contacts() {
-  this->contacts.remove_if(
-      [this](Contact contact) { return contact.last_seen() >= this->timeout; });
+  this->contacts.remove_if([this](Contact& contact) {
+    return contact.last_seen() >= this->timeout;
+  });
   return &contacts;
 }
 
-void ContactList::update(ADSBMessage message) {
+bool ContactList::update(ADSBMessage message) {
   Contact* existing_contact = this->get_contact(message.icao);
   if (existing_contact != nullptr) {
-    existing_contact->update(message);
+    AlertChange alert_change = existing_contact->update(message);
+    if (collect_events) {
+      if (alert_change.emergency) {
+        events.emplace_back(EMERGENCY_EVENT, *existing_contact);
+      }
+      if (alert_change.acas_ra) {
+        events.emplace_back(ACAS_RA_EVENT, *existing_contact);
+      }
+      if (alert_change.emergency_squawk) {
+        events.emplace_back(SQUAWK_EVENT, *existing_contact);
+      }
+    }
+    return alert_change.any();
   } else {
-    Contact* contact;
     if (this->position_ref_status == KNOWN) {
-      contact = new Contact(message, this->lat_ref, this->lon_ref);
+      this->contacts.emplace_front(message, this->lat_ref, this->lon_ref,
+                                   this->max_range_nm);
     } else {
-      contact = new Contact(message);
+      this->contacts.emplace_front(message);
+    }
+    Contact& contact = this->contacts.front();
+    contact.clock = this->clock;
+    if (registry != nullptr) contact.lookup_registry(*registry);
+    if (collect_events) {
+      events.emplace_back(NEW_CONTACT_EVENT, contact);
+      if (is_declared_emergency(contact.emergency_state)) {
+        events.emplace_back(EMERGENCY_EVENT, contact);
+      }
+      if (contact.acas_ra_active == TRUE) {
+        events.emplace_back(ACAS_RA_EVENT, contact);
+      }
+      if (is_emergency_squawk(contact.squawk)) {
+        events.emplace_back(SQUAWK_EVENT, contact);
+      }
+    }
+    return contact.has_alert();
+  }
+}
+
+std::vector<ContactEvent> ContactList::take_events() {
+  std::vector<ContactEvent> taken;
+  taken.swap(events);
+  return taken;
+}
+
+ContactEvent::ContactEvent(ContactEventType type, const Contact& contact)
+    : type(type),
+      icao(contact.icao),
+      callsign(contact.callsign),
+      squawk(contact.squawk),
+      emergency_state(contact.emergency_state),
+      acas_ra_active(contact.acas_ra_active),
+      acas_ra(
+          acas_ra_to_string(contact.acas_ra, contact.acas_multiple_threats)),
+      timestamp(contact.last_message) {}
+
+std::string ContactEvent::to_json() {
+  std::stringstream ss;
+  ss << "{";
+  ss << "\"event\": \"" << contact_event_type_to_string(type) << "\",";
+  ss << "\"icao\": \"" << icao << "\",";
+  ss << "\"callsign\": \"" << callsign << "\",";
+  ss << "\"squawk\": \"" << squawk << "\",";
+  ss << "\"emergency_state\": \""
+     << emergency_state_to_string(emergency_state) << "\",";
+  ss << "\"acas_ra_active\": \"" << bool_value_to_string(acas_ra_active)
+     << "\",";
+  ss << "\"acas_ra\": \"" << acas_ra << "\",";
+  ss << "\"timestamp\": "
+     << std::chrono::duration_cast<std::chrono::milliseconds>(
+            timestamp.time_since_epoch())
+            .count();
+  ss << "}";
+  return ss.str();
+}
+
+std::string contact_event_type_to_string(ContactEventType value) {
+  switch (value) {
+    case NEW_CONTACT_EVENT:
+      return "new_contact";
+    case EMERGENCY_EVENT:
+      return "emergency";
+    case ACAS_RA_EVENT:
+      return "acas_ra";
+    case SQUAWK_EVENT:
+      return "squawk";
+    default:
+      return "unknown";
+  }
+}
+
+double max_plausible_speed_kt(int type_code, int category) {
+  if (type_code == 2) {
+    // surface vehicles and obstacles
+    return 100;
+  } else if (type_code == 3) {
+    switch (category) {
+      case 1:  // glider
+      case 3:  // parachutist
+      case 4:  // ultralight
+        return 250;
+      case 2:  // lighter than air
+        return 150;
+      case 7:  // space vehicle
+        return 20000;
+    }
+  } else if (type_code == 4) {
+    switch (category) {
+      case 1:  // light
+      case 7:  // rotorcraft
+        return 350;
+      case 2:  // small
+      case 3:  // large
+      case 4:  // high vortex large
+      case 5:  // heavy
+        return 800;
     }
-    this->contacts.push_front(*contact);
   }
+  // unknown category or high performance aircraft
+  return 2000;
+}
+
+bool is_declared_emergency(EmergencyState state) {
+  return state != NO_EMERGENCY && state != UNDETERMINED_EMERGENCY;
+}
+
+bool is_emergency_squawk(const std::string& squawk) {
+  return squawk == "7500" || squawk == "7600" || squawk == "7700";
 }
 
 Contact* ContactList::get_contact(std::string icao) {
@@ -62,12 +183,17 @@ std::string ContactList::to_json() {
   return ss.str();
 }
 
-Contact::Contact(ADSBMessage message, double lat_ref, double lon_ref) {
+Contact::Contact(ADSBMessage message, double lat_ref, double lon_ref)
+    : Contact(message, lat_ref, lon_ref, 0) {}
+
+Contact::Contact(ADSBMessage message, double lat_ref, double lon_ref,
+                 double max_range_nm) {
   icao = message.icao;
   first_message = message.timestamp;
   this->lat_ref = lat_ref;
   this->lon_ref = lon_ref;
   this->position_ref_status = KNOWN;
+  this->max_range_nm = max_range_nm;
   this->update(message);
 }
 
@@ -77,17 +203,155 @@ Contact::Contact(ADSBMessage message) {
   this->update(message);
 }
 
-void Contact::update(ADSBMessage message) {
+namespace {
+
+int64_t to_ms(std::chrono::system_clock::time_point time) {
+  return std::chrono::duration_cast<std::chrono::milliseconds>(
+             time.time_since_epoch())
+      .count();
+}
+
+std::chrono::system_clock::time_point from_ms(int64_t ms) {
+  return std::chrono::system_clock::time_point(std::chrono::milliseconds(ms));
+}
+
+template <size_t N>
+void copy_field(const std::string& value, char (&field)[N]) {
+  std::memset(field, 0, N);
+  std::memcpy(field, value.data(), std::min(value.size(), N));
+}
+
+template <size_t N>
+std::string field_string(const char (&field)[N]) {
+  return std::string(field, strnlen(field, N));
+}
+
+}  // namespace
+
+Contact::Contact(const ContactRecord& record) {
+  icao = field_string(record.icao);
+  callsign = field_string(record.callsign);
+  squawk = field_string(record.squawk);
+  aircraft_category = field_string(record.aircraft_category);
+  first_message = from_ms(record.first_message_ms);
+  last_message = from_ms(record.last_message_ms);
+  n_messages = record.n_messages;
+
+  speed_type = static_cast<SpeedType>(record.speed_type);
+  speed = record.speed;
+  heading_type = static_cast<HeadingType>(record.heading_type);
+  heading = record.heading;
+  altitude_type = static_cast<AltitudeType>(record.altitude_type);
+  altitude = record.altitude;
+  vertical_rate_source =
+      static_cast<VerticalRateSource>(record.vertical_rate_source);
+  vertical_rate_status = static_cast<FieldStatus>(record.vertical_rate_status);
+  vertical_rate = record.vertical_rate;
+  emergency_state = static_cast<EmergencyState>(record.emergency_state);
+  adsb_version = record.adsb_version;
+  nac_p = record.nac_p;
+  sil = record.sil;
+  max_speed_kt = record.max_speed_kt;
+
+  position_status = static_cast<FieldStatus>(record.position_status);
+  position_validated = record.position_validated;
+  position_timestamp = from_ms(record.position_ms);
+  lat = record.lat;
+  lon = record.lon;
+  even_lat_cpr = record.even_lat_cpr;
+  even_lon_cpr = record.even_lon_cpr;
+  even_tc = record.even_tc;
+  even_timestamp = from_ms(record.even_ms);
+  odd_lat_cpr = record.odd_lat_cpr;
+  odd_lon_cpr = record.odd_lon_cpr;
+  odd_tc = record.odd_tc;
+  odd_timestamp = from_ms(record.odd_ms);
+  this->update_velocity();
+}
+
+ContactRecord Contact::to_record() const {
+  ContactRecord record{};
+  copy_field(icao, record.icao);
+  copy_field(callsign, record.callsign);
+  copy_field(squawk, record.squawk);
+  copy_field(aircraft_category, record.aircraft_category);
+  record.first_message_ms = to_ms(first_message);
+  record.last_message_ms = to_ms(last_message);
+  record.n_messages = n_messages;
+
+  record.speed_type = speed_type;
+  record.speed = speed;
+  record.heading_type = heading_type;
+  record.heading = heading;
+  record.altitude_type = altitude_type;
+  record.altitude = altitude;
+  record.vertical_rate_source = vertical_rate_source;
+  record.vertical_rate_status = vertical_rate_status;
+  record.vertical_rate = vertical_rate;
+  record.emergency_state = emergency_state;
+  record.adsb_version = adsb_version;
+  record.nac_p = nac_p;
+  record.sil = sil;
+  record.max_speed_kt = max_speed_kt;
+
+  record.position_status = position_status;
+  record.position_validated = position_validated;
+  record.position_ms = to_ms(position_timestamp);
+  record.lat = lat;
+  record.lon = lon;
+  record.even_lat_cpr = even_lat_cpr;
+  record.even_lon_cpr = even_lon_cpr;
+  record.even_tc = even_tc;
+  record.even_ms = to_ms(even_timestamp);
+  record.odd_lat_cpr = odd_lat_cpr;
+  record.odd_lon_cpr = odd_lon_cpr;
+  record.odd_tc = odd_tc;
+  record.odd_ms = to_ms(odd_timestamp);
+  return record;
+}
+
+void Contact::lookup_registry(const AircraftRegistry& registry) {
+  registry_enabled = true;
+  const RegistryRecord* record =
+      registry.lookup(std::strtoul(icao.c_str(), nullptr, 16));
+  if (record != nullptr) {
+    registration = registry_field(record->registration);
+    type_designator = registry_field(record->type_designator);
+    operator_name = registry_field(record->operator_name);
+  }
+}
+
+AlertChange Contact::update(ADSBMessage message) {
   // return if icao does not match
   if (icao.compare(message.icao) != 0) {
-    return;
+    return {};
   }
+  EmergencyState last_emergency_state = emergency_state;
+  BoolValue last_acas_ra_active = acas_ra_active;
+  int last_acas_ra = acas_ra;
+  AlertChange alert_change;
+
+  // altitude and identity replies to interrogations
+  if (!message.squawk.empty()) {
+    alert_change.emergency_squawk =
+        message.squawk != squawk && is_emergency_squawk(message.squawk);
+    squawk = message.squawk;
+  }
+  if ((message.downlink_format == 0 || message.downlink_format == 4 ||
+       message.downlink_format == 16 || message.downlink_format == 20) &&
+      message.altitude_type != UNDETERMINED_ALT) {
+    altitude = message.altitude;
+    altitude_type = message.altitude_type;
+  }
+  if (message.bds != UNKNOWN_BDS) this->update_comm_b(message);
 
   if (message.type_code >= 1 && message.type_code <= 4) {
     // aircraft identification
     callsign = message.callsign;
     this->aircraft_category =
         short_aircraft_category(message.type_code, message.aircraft_category);
+    max_speed_kt =
+        max_plausible_speed_kt(message.type_code, message.aircraft_category);
   } else if (message.type_code >= 5 && message.type_code <= 8) {
     // surface position
     if (position_ref_status == KNOWN) this->update_position(message);
@@ -138,15 +402,112 @@ void Contact::update(ADSBMessage message) {
     lnav_mode = message.lnav_mode;
     vnav_mode = message.vnav_mode;
     tcas_operational = message.tcas_operational;
+    if (message.emergency_state != UNDETERMINED_EMERGENCY) {
+      emergency_state = message.emergency_state;
+    }
+  } else if (message.type_code == 28) {
+    if (message.emergency_state != UNDETERMINED_EMERGENCY) {
+      emergency_state = message.emergency_state;
+    }
+    if (message.acas_ra_status == KNOWN) this->update_acas(message);
+  } else if (message.type_code == 31) {
+    adsb_version = message.adsb_version;
+    if (message.nac_p >= 0) nac_p = message.nac_p;
+    if (message.sil >= 0) sil = message.sil;
+  }
+
+  if (message.type_code >= 5 && message.type_code <= 22) {
+    this->update_velocity();
+  }
+
+  if (message.cpr_status == KNOWN && position_status == KNOWN &&
+      position_timestamp == message.timestamp) {
+    track.add({message.timestamp, static_cast<float>(lat),
+               static_cast<float>(lon), altitude, static_cast<float>(speed),
+               static_cast<float>(heading)});
   }
 
   // update stats
   n_messages++;
   last_message = message.timestamp;
+  if (message.signal_status == KNOWN) this->update_signal(message);
+
+  // a first report of no emergency or no RA is not an alert change
+  alert_change.emergency = emergency_state != last_emergency_state &&
+                           (is_declared_emergency(emergency_state) ||
+                            is_declared_emergency(last_emergency_state));
+  alert_change.acas_ra =
+      (acas_ra_active == TRUE) != (last_acas_ra_active == TRUE) ||
+      (acas_ra_active == TRUE && acas_ra != last_acas_ra);
+  return alert_change;
+}
+
+bool Contact::has_alert() {
+  return is_declared_emergency(emergency_state) || acas_ra_active == TRUE;
+}
+
+void Contact::update_acas(ADSBMessage message) {
+  acas_ra = message.acas_ra;
+  acas_multiple_threats = message.acas_multiple_threats;
+  // an RA is announced by ARA bit 1 or the multiple threat bit and stays
+  // in the broadcast for some seconds after being terminated
+  bool announced = (acas_ra >> 13) || acas_multiple_threats == TRUE;
+  acas_ra_active =
+      (announced && message.acas_ra_terminated != TRUE) ? TRUE : FALSE;
+}
+
+void Contact::update_comm_b(ADSBMessage message) {
+  if (message.bds == BDS20) {
+    callsign = message.callsign;
+  } else if (message.bds == BDS30) {
+    this->update_acas(message);
+  } else if (message.bds == BDS40) {
+    if (message.selected_altitude_status == KNOWN) {
+      selected_altitude = message.selected_altitude;
+      selected_altitude_status = KNOWN;
+      selected_altitude_source = message.selected_altitude_source;
+    }
+    if (message.baro_pressure_setting_status == KNOWN) {
+      baro_pressure_setting = message.baro_pressure_setting;
+      baro_pressure_setting_status = KNOWN;
+    }
+  } else if (message.bds == BDS50) {
+    if (message.roll_angle_status == KNOWN) {
+      roll_angle = message.roll_angle;
+      roll_angle_status = KNOWN;
+    }
+    if (message.true_airspeed_status == KNOWN) {
+      true_airspeed = message.true_airspeed;
+      true_airspeed_status = KNOWN;
+    }
+  } else if (message.bds == BDS60) {
+    if (message.magnetic_heading_status == KNOWN) {
+      magnetic_heading = message.magnetic_heading;
+      magnetic_heading_status = KNOWN;
+    }
+    if (message.mach_status == KNOWN) {
+      mach = message.mach;
+      mach_status = KNOWN;
+    }
+  }
+}
+
+void Contact::update_signal(ADSBMessage message) {
+  n_signal_messages++;
+  rssi = message.rssi;
+  if (signal_status == UNDETERMINED) {
+    rssi_min = rssi;
+    rssi_max = rssi;
+  }
+  rssi_min = std::min(rssi_min, rssi);
+  rssi_max = std::max(rssi_max, rssi);
+  rssi_mean += (rssi - rssi_mean) / n_signal_messages;
+  noise += (message.noise - noise) / n_signal_messages;
+  signal_status = KNOWN;
 }
 
 int Contact::last_seen() {
-  std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
+  std::chrono::system_clock::time_point now = clock->now();
   return std::chrono::duration_cast<std::chrono::seconds>(now - last_message)
       .count();
 }
@@ -163,105 +524,136 @@ void Contact::update_position(ADSBMessage message) {
     odd_timestamp = message.timestamp;
     odd_tc = message.type_code;
   }
+  bool surface = message.type_code < 9;
 
-  // Do not update position if current state mixes ground and airborne position
-  // tc 5-8 ground position
-  // tc 9-18, 20-22 airborne position
-  if ((odd_tc < 9 and even_tc >= 9) || (odd_tc >= 9 && even_tc < 9)) {
-    return;
+  double new_lat, new_lon;
+  bool validated = true;
+  auto position_age = std::chrono::duration_cast<std::chrono::seconds>(
+                          message.timestamp - position_timestamp)
+                          .count();
+  if (position_status == KNOWN && position_validated &&
+      std::abs(position_age) <= max_local_age_s) {
+    // a validated track is continued from its last position with single
+    // frames
+    decode_cpr_local(message.lat_cpr, message.lon_cpr, message.cpr_format,
+                     surface, lat, lon, &new_lat, &new_lon);
+  } else if (!this->update_global_position(&new_lat, &new_lon)) {
+    // first fix from a single frame if the receiver range rules out
+    // ambiguity, it is replaced by the global decode once an even/odd pair is
+    // available
+    if (position_ref_status != KNOWN || max_range_nm <= 0 ||
+        (!surface && max_range_nm >= 180)) {
+      return;
+    }
+    decode_cpr_local(message.lat_cpr, message.lon_cpr, message.cpr_format,
+                     surface, lat_ref, lon_ref, &new_lat, &new_lon);
+    if (distance_nm(lat_ref, lon_ref, new_lat, new_lon) > max_range_nm) {
+      return;
+    }
+    validated = false;
   }
 
-  // Do not update position if messages are longer than max_cpr_delay_s apart
-  auto abs_delay = std::abs(std::chrono::duration_cast<std::chrono::seconds>(
-                                even_timestamp - odd_timestamp)
-                                .count());
-  if (abs_delay > max_cpr_delay_s) {
+  // only a validated track is trusted enough to reject positions against
+  if (position_status == KNOWN && position_validated &&
+      !this->is_plausible_position(new_lat, new_lon, message.timestamp)) {
+    n_rejected_positions++;
+    if (++position_rejections >= max_position_rejections) {
+      // the track itself is probably wrong, start over with a global decode
+      position_status = UNDETERMINED;
+      position_validated = false;
+      position_rejections = 0;
+    }
     return;
   }
 
-  // calculate lat
-  int j = std::floor((59.0 * even_lat_cpr - 60 * odd_lat_cpr) + 0.5);
-  double lat_even = 6.0 * (pos_mod(j, 60) + even_lat_cpr);
-  double lat_odd = 360.0 / 59.0 * (pos_mod(j, 59) + odd_lat_cpr);
-  if (odd_tc < 9.0) {
-    lat_even = (lat_ref > 0) ? lat_even / 4.0 : lat_even / 4.0 - 90.0;
-    lat_odd = (lat_ref > 0) ? lat_odd / 4.0 : lat_odd / 4.0 - 90.0;
-  } else {
-    if (lat_even >= 270.0) lat_even -= 360.0;
-    if (lat_odd >= 270.0) lat_odd -= 360.0;
-  }
+  lat = new_lat;
+  lon = new_lon;
+  position_status = KNOWN;
+  position_validated = validated;
+  position_timestamp = message.timestamp;
+  position_rejections = 0;
+}
 
-  if (compute_NL(lat_even) == compute_NL(lat_odd)) {
-    if (even_timestamp > odd_timestamp) {
-      lat = lat_even;
-    } else {
-      lat = lat_odd;
-    }
-  } else {
+bool Contact::is_plausible_position(
+    double new_lat, double new_lon,
+    std::chrono::system_clock::time_point timestamp) {
+  double hours =
+      std::abs(std::chrono::duration<double>(timestamp - position_timestamp)
+                   .count()) /
+      3600;
+  return distance_nm(lat, lon, new_lat, new_lon) <=
+         max_speed_kt * hours + position_tolerance_nm;
+}
+
+void Contact::update_velocity() {
+  velocity_known =
+      position_status == KNOWN &&
+      ((speed_type == GROUND_SPEED && heading_type == TRACK_ANGLE) ||
+       (speed_type == GROUND_MOVEMENT && heading_type == GROUND_HEADING));
+  if (!velocity_known) {
     return;
   }
-  position_status = KNOWN;
-  // calculate lon
-  int NL_lat = compute_NL(lat);
-  int NL_lat_odd = compute_NL(lat) - 1;
-
-  int m =
-      std::floor(even_lon_cpr * (NL_lat - 1.0) - odd_lon_cpr * NL_lat + 0.5);
-  int n_even, n_odd;
-  if (NL_lat >= 1.0) {
-    n_even = NL_lat;
-  } else {
-    n_even = 1.0;
+  // flat earth is accurate enough over a few seconds
+  double track = heading * M_PI / 180;
+  double nm_per_s = speed / 3600;
+  lat_rate = nm_per_s * std::cos(track) / 60;
+  lon_rate = nm_per_s * std::sin(track) / (60 * std::cos(lat * M_PI / 180));
+}
+
+bool Contact::extrapolate_position(std::chrono::system_clock::time_point time,
+                                   double* extrapolated_lat,
+                                   double* extrapolated_lon) {
+  if (position_status != KNOWN || !velocity_known) {
+    return false;
   }
-  if (NL_lat_odd >= 1.0) {
-    n_odd = NL_lat_odd;
-  } else {
-    n_odd = 1.0;
+  double seconds =
+      std::chrono::duration<double>(time - position_timestamp).count();
+  if (seconds < 0 || seconds > max_extrapolation_s) {
+    return false;
   }
+  *extrapolated_lat = lat + lat_rate * seconds;
+  *extrapolated_lon = lon + lon_rate * seconds;
+  return true;
+}
 
-  double lon_even = 360.0 / n_even * (pos_mod(m, n_even) + even_lon_cpr);
-  double lon_odd = 360.0 / n_odd * (pos_mod(m, n_odd) + odd_lon_cpr);
-  if (odd_tc < 9.0) {
-    lon_even = lon_even / 4.0;
-    lon_odd = lon_odd / 4.0;
-  }
-  if (even_timestamp > odd_timestamp) {
-    lon = lon_even;
-  } else {
-    lon = lon_odd;
+bool Contact::update_global_position(double* new_lat, double* new_lon) {
+  // Do not update position if current state mixes ground and airborne position
+  // tc 5-8 ground position
+  // tc 9-18, 20-22 airborne position
+  if ((odd_tc < 9 and even_tc >= 9) || (odd_tc >= 9 && even_tc < 9)) {
+    return false;
   }
-  if (odd_tc < 9.0) {
-    std::array<double, 4> lons = {lon, lon + 90, lon + 180, lon + 270};
-    for (double& val : lons) {
-      val = std::fmod(val + 180, 360) - 180;
-    }
-    double min_diff = std::abs(lon_ref - lons[0]);
-    size_t imin = 0;
-    for (size_t i = 1; i < lons.size(); ++i) {
-      double diff = std::abs(lon_ref - lons[i]);
-      if (diff < min_diff) {
-        min_diff = diff;
-        imin = i;
-      }
-    }
-    lon = lons[imin];
-  } else {
-    if (lon >= 180) lon = lon - 360;
+
+  // Do not update position if messages are longer than max_cpr_delay_s apart
+  auto abs_delay = std::abs(std::chrono::duration_cast<std::chrono::seconds>(
+                                even_timestamp - odd_timestamp)
+                                .count());
+  if (abs_delay > max_cpr_delay_s) {
+    return false;
   }
-}
 
-int pos_mod(int m, int n) {
-  int mod = m % n;
-  if (mod < 0) mod += n;
-  return mod;
+  return decode_cpr_global(even_lat_cpr, even_lon_cpr, odd_lat_cpr,
+                           odd_lon_cpr, !(even_timestamp > odd_timestamp),
+                           odd_tc < 9, lat_ref, lon_ref, new_lat, new_lon);
 }
 
-std::string Contact::to_json() {
+std::string Contact::to_json(bool extrapolate) {
+  double json_lat = lat;
+  double json_lon = lon;
+  bool extrapolated = extrapolate && this->extrapolate_position(
+                                         clock->now(), &json_lat, &json_lon);
+
   std::stringstream ss;
   ss << "{";
   ss << "\"icao\": \"" << icao << "\",";
   ss << "\"callsign\": \"" << callsign << "\",";
   ss << "\"aircraft_category\": \"" << aircraft_category << "\",";
+  ss << "\"squawk\": \"" << squawk << "\",";
+  if (registry_enabled) {
+    ss << "\"registration\": \"" << registration << "\",";
+    ss << "\"type_designator\": \"" << type_designator << "\",";
+    ss << "\"operator\": \"" << operator_name << "\",";
+  }
   ss << "\"speed_type\": \"" << speed_type_value_to_string(speed_type) << "\",";
   ss << "\"speed\": \"" << speed << "\",";
   ss << "\"heading_type\": \"" << heading_type_value_to_string(heading_type)
@@ -280,8 +672,10 @@ std::string Contact::to_json() {
      << field_status_to_string(altitude_delta_status) << "\",";
   ss << "\"position_status\": \"" << field_status_to_string(position_status)
      << "\",";
-  ss << "\"lat\": " << lat << ",";
-  ss << "\"lon\": " << lon << ",";
+  ss << "\"lat\": " << json_lat << ",";
+  ss << "\"lon\": " << json_lon << ",";
+  ss << "\"position_extrapolated\": \""
+     << bool_value_to_string(extrapolated ? TRUE : FALSE) << "\",";
   ss << "\"position_ref_status\": \""
      << field_status_to_string(position_ref_status) << "\",";
   ss << "\"lat_ref\": " << lat_ref << ",";
@@ -312,7 +706,35 @@ std::string Contact::to_json() {
   ss << "\"baro_pressure_setting_status\": \""
      << field_status_to_string(baro_pressure_setting_status) << "\",";
   ss << "\"baro_pressure_setting\": " << baro_pressure_setting << ",";
+  ss << "\"roll_angle_status\": \""
+     << field_status_to_string(roll_angle_status) << "\",";
+  ss << "\"roll_angle\": " << roll_angle << ",";
+  ss << "\"true_airspeed_status\": \""
+     << field_status_to_string(true_airspeed_status) << "\",";
+  ss << "\"true_airspeed\": " << true_airspeed << ",";
+  ss << "\"mach_status\": \"" << field_status_to_string(mach_status) << "\",";
+  ss << "\"mach\": " << mach << ",";
+  ss << "\"magnetic_heading_status\": \""
+     << field_status_to_string(magnetic_heading_status) << "\",";
+  ss << "\"magnetic_heading\": " << magnetic_heading << ",";
+  ss << "\"emergency_state\": \""
+     << emergency_state_to_string(emergency_state) << "\",";
+  ss << "\"acas_ra_active\": \"" << bool_value_to_string(acas_ra_active)
+     << "\",";
+  ss << "\"acas_ra\": \"" << acas_ra_to_string(acas_ra, acas_multiple_threats)
+     << "\",";
+  ss << "\"adsb_version\": " << adsb_version << ",";
+  ss << "\"nac_p\": " << nac_p << ",";
+  ss << "\"sil\": " << sil << ",";
+  ss << "\"signal_status\": \"" << field_status_to_string(signal_status)
+     << "\",";
+  ss << "\"rssi\": " << rssi << ",";
+  ss << "\"rssi_mean\": " << rssi_mean << ",";
+  ss << "\"rssi_min\": " << rssi_min << ",";
+  ss << "\"rssi_max\": " << rssi_max << ",";
+  ss << "\"noise\": " << noise << ",";
   ss << "\"n_messages\": " << n_messages << ",";
+  ss << "\"n_rejected_positions\": " << n_rejected_positions << ",";
   ss << "\"last_seen\": " << this->last_seen();
   ss << "}";
   return ss.str();
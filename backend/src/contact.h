@@ -2,16 +2,83 @@
 #define ADSBOOST_CONTACT_H_
 
 #include <condition_variable>
+#include <cstdint>
 #include <list>
 #include <mutex>
+#include <vector>
 
 #include "adsb_message.h"
+#include "clock.h"
+#include "cpr.h"
+#include "registry.h"
+#include "track_history.h"
+
+// ground speed limit for the aircraft category of an identification message,
+// generous to leave room for tailwind
+double max_plausible_speed_kt(int type_code, int category);
+
+// Fixed size image of the state needed to continue tracking a contact after a
+// restart, including unpaired CPR frames. Times are ms since epoch.
+struct ContactRecord {
+  int64_t first_message_ms;
+  int64_t last_message_ms;
+  int64_t position_ms;
+  int64_t even_ms;
+  int64_t odd_ms;
+  double lat;
+  double lon;
+  double speed;
+  double heading;
+  double max_speed_kt;
+  double even_lat_cpr;
+  double even_lon_cpr;
+  double odd_lat_cpr;
+  double odd_lon_cpr;
+  int32_t altitude;
+  int32_t vertical_rate;
+  int32_t n_messages;
+  int8_t even_tc;
+  int8_t odd_tc;
+  int8_t adsb_version;
+  int8_t nac_p;
+  int8_t sil;
+  uint8_t speed_type;
+  uint8_t heading_type;
+  uint8_t altitude_type;
+  uint8_t vertical_rate_source;
+  uint8_t vertical_rate_status;
+  uint8_t position_status;
+  uint8_t position_validated;
+  uint8_t emergency_state;
+  char icao[6];
+  char callsign[8];
+  char squawk[4];
+  char aircraft_category[4];
+};
+
+static_assert(sizeof(ContactRecord) == 160);
+
+// alerts of a contact that a message raised, changed or cleared
+struct AlertChange {
+  bool emergency = false;
+  bool acas_ra = false;
+  // the squawk changed to an emergency code, reported as event only
+  bool emergency_squawk = false;
+  bool any() const { return emergency || acas_ra; }
+};
 
 class Contact {
  public:
   std::string icao = "";
   std::string callsign = "";
   std::string aircraft_category = "";
+  std::string squawk = "";
+
+  // from the aircraft registry, only part of the JSON if one is loaded
+  bool registry_enabled = false;
+  std::string registration = "";
+  std::string type_designator = "";
+  std::string operator_name = "";
 
   SpeedType speed_type = UNDETERMINED_SPEED;
   double speed = 0.0;
@@ -35,6 +102,12 @@ class Contact {
   FieldStatus position_ref_status = UNDETERMINED;
   double lat_ref = 0;
   double lon_ref = 0;
+  // receiver range in NM, allows a first fix from a single frame (0: off)
+  double max_range_nm = 0;
+  // positions implying a higher ground speed than the aircraft category allows
+  // are rejected
+  double max_speed_kt = max_plausible_speed_kt(0, 0);
+  int n_rejected_positions = 0;
 
   BoolValue autopilot = UNDETERMINED_BOOL;
   BoolValue lnav_mode = UNDETERMINED_BOOL;
@@ -59,54 +132,152 @@ class Contact {
   FieldStatus baro_pressure_setting_status = UNDETERMINED;
   int baro_pressure_setting = -1;
 
+  // from Comm-B replies
+  FieldStatus roll_angle_status = UNDETERMINED;
+  double roll_angle = 0.0;
+  FieldStatus true_airspeed_status = UNDETERMINED;
+  int true_airspeed = 0;
+  FieldStatus mach_status = UNDETERMINED;
+  double mach = 0.0;
+  FieldStatus magnetic_heading_status = UNDETERMINED;
+  double magnetic_heading = 0.0;
+
+  EmergencyState emergency_state = UNDETERMINED_EMERGENCY;
+  // last resolution advisory of TC28 subtype 2 or Comm-B register 3,0
+  BoolValue acas_ra_active = UNDETERMINED_BOOL;
+  int acas_ra = 0;
+  BoolValue acas_multiple_threats = UNDETERMINED_BOOL;
+
+  int adsb_version = -1;
+  int nac_p = -1;
+  int sil = -1;
+
+  // signal statistics in dBFS, over the messages with known signal level
+  FieldStatus signal_status = UNDETERMINED;
+  double rssi = 0.0;
+  double rssi_mean = 0.0;
+  double rssi_min = 0.0;
+  double rssi_max = 0.0;
+  double noise = 0.0;
+  int n_signal_messages = 0;
+
+  // downsampled past positions
+  TrackHistory track;
+
   // stats
   int n_messages = 0;
   std::chrono::system_clock::time_point first_message;
   std::chrono::system_clock::time_point last_message;
 
+  Clock* clock = default_clock();
+
   Contact(ADSBMessage message);
   Contact(ADSBMessage message, double lat_ref, double lon_ref);
-  void update(ADSBMessage message);
-  std::string to_json();
+  Contact(ADSBMessage message, double lat_ref, double lon_ref,
+          double max_range_nm);
+  explicit Contact(const ContactRecord& record);
+  ContactRecord to_record() const;
+  void lookup_registry(const AircraftRegistry& registry);
+  AlertChange update(ADSBMessage message);
+  // position moved along the ground track to the given time, false if the
+  // ground velocity is unknown or the last fix is too old
+  bool extrapolate_position(std::chrono::system_clock::time_point time,
+                            double* extrapolated_lat,
+                            double* extrapolated_lon);
+  // with extrapolate, lat/lon are extrapolated to the current time where
+  // possible and flagged by position_extrapolated
+  std::string to_json(bool extrapolate = false);
   int last_seen();
+  // declared emergency or active resolution advisory
+  bool has_alert();
 
  private:
   void update_position(ADSBMessage message);
+  void update_signal(ADSBMessage message);
+  void update_comm_b(ADSBMessage message);
+  void update_acas(ADSBMessage message);
+  void update_velocity();
+  bool update_global_position(double* new_lat, double* new_lon);
+  bool is_plausible_position(double new_lat, double new_lon,
+                             std::chrono::system_clock::time_point timestamp);
   int max_cpr_delay_s = 10;
-  double even_lat_cpr;
-  double even_lon_cpr;
-  int even_tc;
+  // single frames are decoded relative to a validated position this recent
+  int max_local_age_s = 60;
+  // allowance for the CPR resolution and timestamp jitter
+  double position_tolerance_nm = 0.5;
+  // the track is reinitialized after this many rejected positions in a row
+  int max_position_rejections = 3;
+  int position_rejections = 0;
+  // ground velocity in degrees per second at the last position, for dead
+  // reckoning up to max_extrapolation_s after it
+  bool velocity_known = false;
+  double lat_rate = 0;
+  double lon_rate = 0;
+  int max_extrapolation_s = 10;
+  bool position_validated = false;
+  std::chrono::system_clock::time_point position_timestamp;
+  double even_lat_cpr = 0;
+  double even_lon_cpr = 0;
+  int even_tc = 0;
   std::chrono::system_clock::time_point even_timestamp;
 
-  double odd_lat_cpr;
-  double odd_lon_cpr;
-  int odd_tc;
+  double odd_lat_cpr = 0;
+  double odd_lon_cpr = 0;
+  int odd_tc = 0;
   std::chrono::system_clock::time_point odd_timestamp;
 };
 
+enum ContactEventType {
+  NEW_CONTACT_EVENT,
+  EMERGENCY_EVENT,
+  ACAS_RA_EVENT,
+  SQUAWK_EVENT
+};
+
+// change of a contact that is pushed to clients right away
+struct ContactEvent {
+  ContactEventType type;
+  std::string icao;
+  std::string callsign;
+  std::string squawk;
+  EmergencyState emergency_state;
+  BoolValue acas_ra_active;
+  std::string acas_ra;
+  std::chrono::system_clock::time_point timestamp;
+
+  ContactEvent(ContactEventType type, const Contact& contact);
+  std::string to_json();
+};
+
+std::string contact_event_type_to_string(ContactEventType value);
+// 7500 (unlawful interference), 7600 (radio failure) and 7700 (emergency)
+bool is_emergency_squawk(const std::string& squawk);
+// an emergency is declared, as opposed to none or not (yet) reported
+bool is_declared_emergency(EmergencyState state);
+
 class ContactList {
  public:
   int timeout = 90;
   double lon_ref;
   double lat_ref;
   FieldStatus position_ref_status = UNDETERMINED;
+  double max_range_nm = 0;
+  // events are only collected when set, and kept until take_events
+  bool collect_events = false;
+  std::vector<ContactEvent> events = {};
   std::list<Contact> contacts = {};
+  Clock* clock = default_clock();
+  // enriches new contacts when set
+  const AircraftRegistry* registry = nullptr;
   ContactList(int timeout);
   ContactList(int timeout, double lat_ref, double lon_ref);
-  void update(ADSBMessage message);
+  // returns whether a contact raised, changed or cleared an alert
+  bool update(ADSBMessage message);
   std::string to_json();
   Contact* get_contact(std::string icao);
   std::list<Contact>* get_contacts();
+  std::vector<ContactEvent> take_events();
   static bool timed_out(Contact&);
 };
 
-struct SharedContactList {
-  ContactList contact_list = ContactList(10);
-  std::mutex mutex;
-  std::condition_variable contacts_ready;
-  bool contacts_updated = false;
-};
-
-int pos_mod(int m, int n);
-
 #endif  // ADSBOOST_CONTACT_H_
\ No newline at end of file
@@ -36,13 +36,14 @@ TEST_F(ContactTest, ContactTestToJson) {
   EXPECT_EQ(
       contact.to_json(),
       "{\"icao\": \"3C6585\",\"callsign\": \"DLH4AH  \",\"aircraft_category\": "
-      "\"MED2\",\"speed_type\": \"UNDETERMINED\",\"speed\": "
+      "\"MED2\",\"squawk\": \"\",\"speed_type\": \"UNDETERMINED\",\"speed\": "
       "\"0\",\"heading_type\": \"UNDETERMINED\",\"heading\": "
       "0,\"altitude_type\": \"UNDETERMINED\",\"altitude\": "
       "0,\"vertical_rate_source\": \"UNDETERMINED\",\"vertical_rate_status\": "
       "\"UNDETERMINED\",\"vertical_rate\": 0,\"altitude_delta\": "
       "0,\"altitude_delta_status\": \"UNDETERMINED\",\"position_status\": "
-      "\"UNDETERMINED\",\"lat\": 0,\"lon\": 0,\"position_ref_status\": "
+      "\"UNDETERMINED\",\"lat\": 0,\"lon\": 0,\"position_extrapolated\": "
+      "\"false\",\"position_ref_status\": "
       "\"UNDETERMINED\",\"lat_ref\": 0,\"lon_ref\": 0,\"autopilot\": "
       "\"NA\",\"lnav_mode\": \"NA\",\"vnav_mode\": \"NA\",\"approach_mode\": "
       "\"NA\",\"tcas_operational\": \"NA\",\"altitude_hold_mode\": "
@@ -54,8 +55,17 @@ TEST_F(ContactTest, ContactTestToJson) {
       "\"UNDETERMINED\",\"selected_altitude\": 0,\"selected_heading_status\": "
       "\"UNDETERMINED\",\"selected_heading\": "
       "0,\"baro_pressure_setting_status\": "
-      "\"UNDETERMINED\",\"baro_pressure_setting\": -1,\"n_messages\": "
-      "1,\"last_seen\": 0}");
+      "\"UNDETERMINED\",\"baro_pressure_setting\": -1,\"roll_angle_status\": "
+      "\"UNDETERMINED\",\"roll_angle\": 0,\"true_airspeed_status\": "
+      "\"UNDETERMINED\",\"true_airspeed\": 0,\"mach_status\": "
+      "\"UNDETERMINED\",\"mach\": 0,\"magnetic_heading_status\": "
+      "\"UNDETERMINED\",\"magnetic_heading\": 0,\"emergency_state\": "
+      "\"UNDETERMINED\",\"acas_ra_active\": \"NA\",\"acas_ra\": "
+      "\"none\",\"adsb_version\": -1,\"nac_p\": -1,\"sil\": "
+      "-1,\"signal_status\": "
+      "\"UNDETERMINED\",\"rssi\": 0,\"rssi_mean\": 0,\"rssi_min\": "
+      "0,\"rssi_max\": 0,\"noise\": 0,\"n_messages\": "
+      "1,\"n_rejected_positions\": 0,\"last_seen\": 0}");
 }
 
 TEST_F(ContactTest, ContactTestAirbornePositionUpdate1) {
@@ -288,6 +298,43 @@ TEST_F(ContactTest, ContactTestGroundPositionUpdate5) {
   EXPECT_NEAR(contact.lat, -21.9102, 1e-4);
 }
 
+TEST_F(ContactTest, ContactTestSingleFramePosition) {
+  std::array<unsigned char, 14> message_even = {0x8d, 0x4b, 0xce, 0x15, 0x60,
+                                                0x09, 0x02, 0xea, 0x94, 0xb7,
+                                                0xdc, 0xb2, 0x52, 0x58};
+  ADSBMessage msg_even = ADSBMessage(message_even);
+  // without a receiver range a single frame is ambiguous
+  Contact contact = Contact(msg_even, 52.0, 13.0);
+  EXPECT_EQ(contact.position_status, UNDETERMINED);
+
+  contact = Contact(msg_even, 52.0, 13.0, 150);
+  EXPECT_EQ(contact.position_status, KNOWN);
+  EXPECT_NEAR(contact.lon, 13.5910, 1e-4);
+  EXPECT_NEAR(contact.lat, 52.3745, 1e-4);
+}
+
+TEST_F(ContactTest, ContactTestLocalPositionUpdate) {
+  std::array<unsigned char, 14> message_even = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                                0xc3, 0x82, 0xd6, 0x90, 0xc8,
+                                                0xac, 0x28, 0x63, 0xa7};
+  std::array<unsigned char, 14> message_odd = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                               0xc3, 0x86, 0x43, 0x5c, 0xc4,
+                                               0x12, 0x69, 0x2a, 0xd6};
+  auto now = std::chrono::system_clock::now();
+  Contact contact = Contact(ADSBMessage(message_odd, now));
+  contact.update(ADSBMessage(message_even, now + std::chrono::seconds(1)));
+  EXPECT_EQ(contact.position_status, KNOWN);
+  EXPECT_NEAR(contact.lat, 52.25720, 1e-4);
+  EXPECT_NEAR(contact.lon, 3.91937, 1e-4);
+
+  // later frames of the track are decoded on their own
+  Contact reference = Contact(ADSBMessage(message_even, now));
+  reference.update(ADSBMessage(message_odd, now + std::chrono::seconds(1)));
+  contact.update(ADSBMessage(message_odd, now + std::chrono::seconds(30)));
+  EXPECT_NEAR(contact.lat, reference.lat, 1e-9);
+  EXPECT_NEAR(contact.lon, reference.lon, 1e-9);
+}
+
 TEST_F(ContactTest, ContactTestGroundPositionUpdateNoReference) {
   std::array<unsigned char, 14> message_even = {0x8c, 0x44, 0x0d, 0xa5, 0x38,
                                                 0x1f, 0x91, 0x95, 0x22, 0x93,
@@ -502,14 +549,15 @@ TEST_F(ContactTest, ContactListTestToJson) {
   EXPECT_EQ(
       contacts.to_json(),
       "{\"contacts\": [{\"icao\": \"4D2414\",\"callsign\": "
-      "\"\",\"aircraft_category\": \"\",\"speed_type\": "
+      "\"\",\"aircraft_category\": \"\",\"squawk\": \"\",\"speed_type\": "
       "\"UNDETERMINED\",\"speed\": \"0\",\"heading_type\": "
       "\"UNDETERMINED\",\"heading\": 0,\"altitude_type\": "
       "\"BAROMETRIC\",\"altitude\": 38025,\"vertical_rate_source\": "
       "\"UNDETERMINED\",\"vertical_rate_status\": "
       "\"UNDETERMINED\",\"vertical_rate\": 0,\"altitude_delta\": "
       "0,\"altitude_delta_status\": \"UNDETERMINED\",\"position_status\": "
-      "\"UNDETERMINED\",\"lat\": 0,\"lon\": 0,\"position_ref_status\": "
+      "\"UNDETERMINED\",\"lat\": 0,\"lon\": 0,\"position_extrapolated\": "
+      "\"false\",\"position_ref_status\": "
       "\"KNOWN\",\"lat_ref\": 40,\"lon_ref\": -35,\"autopilot\": "
       "\"NA\",\"lnav_mode\": \"NA\",\"vnav_mode\": \"NA\",\"approach_mode\": "
       "\"NA\",\"tcas_operational\": \"NA\",\"altitude_hold_mode\": "
@@ -521,16 +569,27 @@ TEST_F(ContactTest, ContactListTestToJson) {
       "\"UNDETERMINED\",\"selected_altitude\": 0,\"selected_heading_status\": "
       "\"UNDETERMINED\",\"selected_heading\": "
       "0,\"baro_pressure_setting_status\": "
-      "\"UNDETERMINED\",\"baro_pressure_setting\": -1,\"n_messages\": "
-      "1,\"last_seen\": 0},{\"icao\": \"3C6585\",\"callsign\": \"DLH4AH  "
-      "\",\"aircraft_category\": \"MED2\",\"speed_type\": "
+      "\"UNDETERMINED\",\"baro_pressure_setting\": -1,\"roll_angle_status\": "
+      "\"UNDETERMINED\",\"roll_angle\": 0,\"true_airspeed_status\": "
+      "\"UNDETERMINED\",\"true_airspeed\": 0,\"mach_status\": "
+      "\"UNDETERMINED\",\"mach\": 0,\"magnetic_heading_status\": "
+      "\"UNDETERMINED\",\"magnetic_heading\": 0,\"emergency_state\": "
+      "\"UNDETERMINED\",\"acas_ra_active\": \"NA\",\"acas_ra\": "
+      "\"none\",\"adsb_version\": -1,\"nac_p\": -1,\"sil\": "
+      "-1,\"signal_status\": "
+      "\"UNDETERMINED\",\"rssi\": 0,\"rssi_mean\": 0,\"rssi_min\": "
+      "0,\"rssi_max\": 0,\"noise\": 0,\"n_messages\": "
+      "1,\"n_rejected_positions\": 0,\"last_seen\": 0},{\"icao\": "
+      "\"3C6585\",\"callsign\": \"DLH4AH  "
+      "\",\"aircraft_category\": \"MED2\",\"squawk\": \"\",\"speed_type\": "
       "\"UNDETERMINED\",\"speed\": \"0\",\"heading_type\": "
       "\"UNDETERMINED\",\"heading\": 0,\"altitude_type\": "
       "\"UNDETERMINED\",\"altitude\": 0,\"vertical_rate_source\": "
       "\"UNDETERMINED\",\"vertical_rate_status\": "
       "\"UNDETERMINED\",\"vertical_rate\": 0,\"altitude_delta\": "
       "0,\"altitude_delta_status\": \"UNDETERMINED\",\"position_status\": "
-      "\"UNDETERMINED\",\"lat\": 0,\"lon\": 0,\"position_ref_status\": "
+      "\"UNDETERMINED\",\"lat\": 0,\"lon\": 0,\"position_extrapolated\": "
+      "\"false\",\"position_ref_status\": "
       "\"KNOWN\",\"lat_ref\": 40,\"lon_ref\": -35,\"autopilot\": "
       "\"NA\",\"lnav_mode\": \"NA\",\"vnav_mode\": \"NA\",\"approach_mode\": "
       "\"NA\",\"tcas_operational\": \"NA\",\"altitude_hold_mode\": "
@@ -542,11 +601,299 @@ TEST_F(ContactTest, ContactListTestToJson) {
       "\"UNDETERMINED\",\"selected_altitude\": 0,\"selected_heading_status\": "
       "\"UNDETERMINED\",\"selected_heading\": "
       "0,\"baro_pressure_setting_status\": "
-      "\"UNDETERMINED\",\"baro_pressure_setting\": -1,\"n_messages\": "
-      "1,\"last_seen\": 0}]}");
+      "\"UNDETERMINED\",\"baro_pressure_setting\": -1,\"roll_angle_status\": "
+      "\"UNDETERMINED\",\"roll_angle\": 0,\"true_airspeed_status\": "
+      "\"UNDETERMINED\",\"true_airspeed\": 0,\"mach_status\": "
+      "\"UNDETERMINED\",\"mach\": 0,\"magnetic_heading_status\": "
+      "\"UNDETERMINED\",\"magnetic_heading\": 0,\"emergency_state\": "
+      "\"UNDETERMINED\",\"acas_ra_active\": \"NA\",\"acas_ra\": "
+      "\"none\",\"adsb_version\": -1,\"nac_p\": -1,\"sil\": "
+      "-1,\"signal_status\": "
+      "\"UNDETERMINED\",\"rssi\": 0,\"rssi_mean\": 0,\"rssi_min\": "
+      "0,\"rssi_max\": 0,\"noise\": 0,\"n_messages\": "
+      "1,\"n_rejected_positions\": 0,\"last_seen\": 0}]}");
 }
 
 TEST_F(ContactTest, ContactListTestToJsonEmpty) {
   ContactList contacts = ContactList(10, 40.0, -35.0);
   EXPECT_EQ(contacts.to_json(), "{\"contacts\": []}");
-}
\ No newline at end of file
+}
+TEST_F(ContactTest, ContactTestSignalStatistics) {
+  std::array<unsigned char, 14> message = {0x8d, 0x3c, 0x65, 0x85, 0x23,
+                                           0x10, 0xc2, 0x34, 0x04, 0x88,
+                                           0x20, 0x5a, 0x8f, 0xaf};
+  ADSBMessage msg = ADSBMessage(message);
+  Contact contact = Contact(msg);
+  EXPECT_EQ(contact.signal_status, UNDETERMINED);
+
+  msg.signal_status = KNOWN;
+  for (double rssi : {-10.0, -20.0, -30.0}) {
+    msg.rssi = rssi;
+    msg.noise = rssi - 20;
+    contact.update(msg);
+  }
+  EXPECT_EQ(contact.signal_status, KNOWN);
+  EXPECT_EQ(contact.rssi, -30.0);
+  EXPECT_NEAR(contact.rssi_mean, -20.0, 1e-9);
+  EXPECT_EQ(contact.rssi_min, -30.0);
+  EXPECT_EQ(contact.rssi_max, -10.0);
+  EXPECT_NEAR(contact.noise, -40.0, 1e-9);
+  EXPECT_EQ(contact.n_messages, 4);
+}
+
+TEST_F(ContactTest, ContactListTestAlerts) {
+  ContactList contacts = ContactList(10);
+  // position report, no alert
+  std::array<unsigned char, 14> position = {0x8d, 0x48, 0x40, 0xd6, 0x58,
+                                            0x22, 0xb2, 0xd6, 0x90, 0xc8,
+                                            0xac, 0x77, 0x7e, 0x4c};
+  EXPECT_FALSE(contacts.update(ADSBMessage(position)));
+
+  std::array<unsigned char, 14> emergency = {0x8d, 0x48, 0x40, 0xd6, 0xe1,
+                                             0x2a, 0xaa, 0x00, 0x00, 0x00,
+                                             0x00, 0x3c, 0xf5, 0xce};
+  EXPECT_TRUE(contacts.update(ADSBMessage(emergency)));
+  EXPECT_FALSE(contacts.update(ADSBMessage(emergency)));
+  Contact* contact = contacts.get_contact("4840D6");
+  EXPECT_EQ(contact->emergency_state, GENERAL_EMERGENCY);
+  EXPECT_EQ(contact->squawk, "7700");
+  EXPECT_TRUE(contact->has_alert());
+
+  std::array<unsigned char, 14> ra = {0x8d, 0x48, 0x40, 0xd6, 0xe2,
+                                      0xc2, 0x00, 0x04, 0xf1, 0xb7,
+                                      0x44, 0x22, 0xbd, 0x62};
+  EXPECT_TRUE(contacts.update(ADSBMessage(ra)));
+  EXPECT_EQ(contact->acas_ra_active, TRUE);
+  EXPECT_NE(contact->to_json().find("\"acas_ra\": \"climb\""),
+            std::string::npos);
+
+  std::array<unsigned char, 14> ra_terminated = {
+      0x8d, 0x48, 0x40, 0xd6, 0xe2, 0xc2, 0x00,
+      0x24, 0xf1, 0xb7, 0x44, 0xa2, 0xdb, 0x3d};
+  EXPECT_TRUE(contacts.update(ADSBMessage(ra_terminated)));
+  EXPECT_EQ(contact->acas_ra_active, FALSE);
+}
+
+TEST_F(ContactTest, ContactTestAlertChange) {
+  std::array<unsigned char, 14> position = {0x8d, 0x48, 0x40, 0xd6, 0x58,
+                                            0x22, 0xb2, 0xd6, 0x90, 0xc8,
+                                            0xac, 0x77, 0x7e, 0x4c};
+  std::array<unsigned char, 14> emergency = {0x8d, 0x48, 0x40, 0xd6, 0xe1,
+                                             0x2a, 0xaa, 0x00, 0x00, 0x00,
+                                             0x00, 0x3c, 0xf5, 0xce};
+  std::array<unsigned char, 14> ra = {0x8d, 0x48, 0x40, 0xd6, 0xe2,
+                                      0xc2, 0x00, 0x04, 0xf1, 0xb7,
+                                      0x44, 0x22, 0xbd, 0x62};
+  Contact contact = Contact(ADSBMessage(position));
+  AlertChange change = contact.update(ADSBMessage(emergency));
+  EXPECT_TRUE(change.emergency);
+  EXPECT_FALSE(change.acas_ra);
+  // the emergency frame carries squawk 7700
+  EXPECT_TRUE(change.emergency_squawk);
+  EXPECT_FALSE(contact.update(ADSBMessage(emergency)).emergency_squawk);
+  change = contact.update(ADSBMessage(ra));
+  EXPECT_FALSE(change.emergency);
+  EXPECT_TRUE(change.acas_ra);
+  EXPECT_FALSE(contact.update(ADSBMessage(ra)).any());
+}
+
+TEST_F(ContactTest, ContactListTestRoutineStatusIsNoAlert) {
+  ContactList contacts = ContactList(10);
+  std::array<unsigned char, 14> position = {0x8d, 0x48, 0x40, 0xd6, 0x58,
+                                            0x22, 0xb2, 0xd6, 0x90, 0xc8,
+                                            0xac, 0x77, 0x7e, 0x4c};
+  EXPECT_FALSE(contacts.update(ADSBMessage(position)));
+
+  // TC28/1 without emergency, squawk 1000
+  std::array<unsigned char, 14> no_emergency = {
+      0x8d, 0x48, 0x40, 0xd6, 0xe1, 0x08, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x88, 0xb2, 0x1f};
+  EXPECT_FALSE(contacts.update(ADSBMessage(no_emergency)));
+  EXPECT_EQ(contacts.get_contact("4840D6")->emergency_state, NO_EMERGENCY);
+
+  // TC29 version 1 target state without emergency
+  std::array<unsigned char, 14> target_state = {
+      0x8d, 0x48, 0x40, 0xd6, 0xe8, 0x84, 0xb4,
+      0x30, 0xe0, 0x00, 0x00, 0x66, 0x0e, 0x5f};
+  ContactList v1_contacts = ContactList(10);
+  EXPECT_FALSE(v1_contacts.update(ADSBMessage(position)));
+  EXPECT_FALSE(v1_contacts.update(ADSBMessage(target_state)));
+  EXPECT_EQ(v1_contacts.get_contact("4840D6")->emergency_state, NO_EMERGENCY);
+
+  // TC28/2 without resolution advisory
+  std::array<unsigned char, 14> no_ra = {0x8d, 0x48, 0x40, 0xd6, 0xe2,
+                                         0x00, 0x00, 0x00, 0x00, 0x00,
+                                         0x00, 0x45, 0x29, 0xbb};
+  EXPECT_FALSE(contacts.update(ADSBMessage(no_ra)));
+  EXPECT_EQ(contacts.get_contact("4840D6")->acas_ra_active, FALSE);
+}
+
+TEST_F(ContactTest, ContactListTestEvents) {
+  ContactList contacts = ContactList(10);
+  std::array<unsigned char, 14> position = {0x8d, 0x48, 0x40, 0xd6, 0x58,
+                                            0x22, 0xb2, 0xd6, 0x90, 0xc8,
+                                            0xac, 0x77, 0x7e, 0x4c};
+  std::array<unsigned char, 14> emergency = {0x8d, 0x48, 0x40, 0xd6, 0xe1,
+                                             0x2a, 0xaa, 0x00, 0x00, 0x00,
+                                             0x00, 0x3c, 0xf5, 0xce};
+  // nothing is collected unless asked for
+  contacts.update(ADSBMessage(position));
+  EXPECT_TRUE(contacts.take_events().empty());
+  contacts.contacts.clear();
+
+  contacts.collect_events = true;
+  contacts.update(ADSBMessage(position));
+  contacts.update(ADSBMessage(position));
+  contacts.update(ADSBMessage(emergency));
+  contacts.update(ADSBMessage(emergency));
+  std::vector<ContactEvent> events = contacts.take_events();
+  ASSERT_EQ(events.size(), 3);
+  EXPECT_EQ(events[0].type, NEW_CONTACT_EVENT);
+  EXPECT_EQ(events[1].type, EMERGENCY_EVENT);
+  EXPECT_EQ(events[1].emergency_state, GENERAL_EMERGENCY);
+  EXPECT_EQ(events[2].type, SQUAWK_EVENT);
+  EXPECT_EQ(events[2].squawk, "7700");
+  EXPECT_TRUE(contacts.take_events().empty());
+
+  std::string json = events[1].to_json();
+  EXPECT_EQ(json.find("{\"event\": \"emergency\",\"icao\": \"4840D6\","), 0);
+  EXPECT_NE(json.find("\"emergency_state\": \"GENERAL\""), std::string::npos);
+}
+
+TEST_F(ContactTest, ContactListTestNoEventsForRoutineStatus) {
+  ContactList contacts = ContactList(10);
+  contacts.collect_events = true;
+  std::array<unsigned char, 14> position = {0x8d, 0x48, 0x40, 0xd6, 0x58,
+                                            0x22, 0xb2, 0xd6, 0x90, 0xc8,
+                                            0xac, 0x77, 0x7e, 0x4c};
+  // TC28/1 without emergency, TC28/2 without resolution advisory
+  std::array<unsigned char, 14> no_emergency = {
+      0x8d, 0x48, 0x40, 0xd6, 0xe1, 0x08, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x88, 0xb2, 0x1f};
+  std::array<unsigned char, 14> no_ra = {0x8d, 0x48, 0x40, 0xd6, 0xe2,
+                                         0x00, 0x00, 0x00, 0x00, 0x00,
+                                         0x00, 0x45, 0x29, 0xbb};
+  std::array<unsigned char, 14> emergency = {0x8d, 0x48, 0x40, 0xd6, 0xe1,
+                                             0x2a, 0xaa, 0x00, 0x00, 0x00,
+                                             0x00, 0x3c, 0xf5, 0xce};
+  contacts.update(ADSBMessage(position));
+  ASSERT_EQ(contacts.take_events().size(), 1);
+  contacts.update(ADSBMessage(no_emergency));
+  contacts.update(ADSBMessage(no_ra));
+  EXPECT_TRUE(contacts.take_events().empty());
+
+  // the end of an emergency is an event
+  contacts.update(ADSBMessage(emergency));
+  contacts.take_events();
+  contacts.update(ADSBMessage(no_emergency));
+  std::vector<ContactEvent> events = contacts.take_events();
+  ASSERT_EQ(events.size(), 1);
+  EXPECT_EQ(events[0].type, EMERGENCY_EVENT);
+  EXPECT_EQ(events[0].emergency_state, NO_EMERGENCY);
+}
+
+TEST_F(ContactTest, ContactTestEmergencySquawk) {
+  EXPECT_TRUE(is_emergency_squawk("7500"));
+  EXPECT_TRUE(is_emergency_squawk("7600"));
+  EXPECT_TRUE(is_emergency_squawk("7700"));
+  EXPECT_FALSE(is_emergency_squawk("7000"));
+  EXPECT_FALSE(is_emergency_squawk(""));
+}
+
+TEST_F(ContactTest, ContactTestImplausiblePosition) {
+  std::array<unsigned char, 14> message_even = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                                0xc3, 0x82, 0xd6, 0x90, 0xc8,
+                                                0xac, 0x28, 0x63, 0xa7};
+  std::array<unsigned char, 14> message_odd = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                               0xc3, 0x86, 0x43, 0x5c, 0xc4,
+                                               0x12, 0x69, 0x2a, 0xd6};
+  // odd frame about 55 NM further north
+  std::array<unsigned char, 14> message_jump = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                                0xc3, 0x86, 0xdf, 0xdc, 0xc4,
+                                                0x12, 0x32, 0x89, 0xea};
+  auto now = std::chrono::system_clock::now();
+  Contact contact = Contact(ADSBMessage(message_odd, now));
+  contact.update(ADSBMessage(message_even, now + std::chrono::seconds(1)));
+  ASSERT_EQ(contact.position_status, KNOWN);
+
+  contact.update(ADSBMessage(message_jump, now + std::chrono::seconds(2)));
+  EXPECT_EQ(contact.n_rejected_positions, 1);
+  EXPECT_EQ(contact.position_status, KNOWN);
+  EXPECT_NEAR(contact.lat, 52.25720, 1e-4);
+  EXPECT_NEAR(contact.lon, 3.91937, 1e-4);
+
+  // a plausible position resets the count of consecutive rejections
+  contact.update(ADSBMessage(message_odd, now + std::chrono::seconds(3)));
+  contact.update(ADSBMessage(message_jump, now + std::chrono::seconds(4)));
+  contact.update(ADSBMessage(message_jump, now + std::chrono::seconds(5)));
+  EXPECT_EQ(contact.n_rejected_positions, 3);
+  EXPECT_EQ(contact.position_status, KNOWN);
+
+  // the track is dropped after repeated rejections and decoded again
+  contact.update(ADSBMessage(message_jump, now + std::chrono::seconds(6)));
+  EXPECT_EQ(contact.n_rejected_positions, 4);
+  EXPECT_EQ(contact.position_status, UNDETERMINED);
+  contact.update(ADSBMessage(message_odd, now + std::chrono::seconds(7)));
+  contact.update(ADSBMessage(message_even, now + std::chrono::seconds(8)));
+  EXPECT_EQ(contact.position_status, KNOWN);
+  EXPECT_NEAR(contact.lat, 52.25720, 1e-4);
+  EXPECT_NEAR(contact.lon, 3.91937, 1e-4);
+}
+
+TEST_F(ContactTest, ContactTestMaxPlausibleSpeed) {
+  // light aircraft, heavy, high performance, unknown
+  EXPECT_EQ(max_plausible_speed_kt(4, 1), 350);
+  EXPECT_EQ(max_plausible_speed_kt(4, 5), 800);
+  EXPECT_EQ(max_plausible_speed_kt(4, 6), 2000);
+  EXPECT_EQ(max_plausible_speed_kt(4, 0), 2000);
+  // surface vehicle, balloon
+  EXPECT_EQ(max_plausible_speed_kt(2, 1), 100);
+  EXPECT_EQ(max_plausible_speed_kt(3, 2), 150);
+}
+
+TEST_F(ContactTest, ContactTestExtrapolatePosition) {
+  std::array<unsigned char, 14> message_even = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                                0xc3, 0x82, 0xd6, 0x90, 0xc8,
+                                                0xac, 0x28, 0x63, 0xa7};
+  std::array<unsigned char, 14> message_odd = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                               0xc3, 0x86, 0x43, 0x5c, 0xc4,
+                                               0x12, 0x69, 0x2a, 0xd6};
+  // ground speed 500 kt, track 36.87 degrees
+  std::array<unsigned char, 14> message_velocity = {
+      0x8d, 0x40, 0x62, 0x1d, 0x99, 0x01, 0x2d,
+      0x32, 0x20, 0x00, 0x00, 0x42, 0x9f, 0xbc};
+  auto now = std::chrono::system_clock::time_point(std::chrono::hours(1));
+  VirtualClock clock;
+  Contact contact = Contact(ADSBMessage(message_odd, now));
+  contact.clock = &clock;
+  double lat, lon;
+  contact.update(ADSBMessage(message_velocity, now));
+  EXPECT_FALSE(
+      contact.extrapolate_position(now + std::chrono::seconds(1), &lat, &lon));
+
+  contact.update(ADSBMessage(message_even, now + std::chrono::seconds(1)));
+  ASSERT_EQ(contact.position_status, KNOWN);
+  EXPECT_NEAR(contact.speed, 500, 1e-9);
+  ASSERT_TRUE(
+      contact.extrapolate_position(now + std::chrono::seconds(7), &lat, &lon));
+  EXPECT_NEAR(distance_nm(contact.lat, contact.lon, lat, lon), 500.0 / 600,
+              1e-3);
+  EXPECT_NEAR(lat - contact.lat, 0.8 * 500.0 / 600 / 60, 1e-5);
+  EXPECT_GT(lon, contact.lon);
+
+  // not before the fix and not long after it
+  EXPECT_FALSE(contact.extrapolate_position(now, &lat, &lon));
+  EXPECT_FALSE(
+      contact.extrapolate_position(now + std::chrono::seconds(20), &lat, &lon));
+
+  clock.advance(now + std::chrono::seconds(7));
+  EXPECT_NE(contact.to_json().find("\"position_extrapolated\": \"false\""),
+            std::string::npos);
+  std::string json = contact.to_json(true);
+  EXPECT_NE(json.find("\"position_extrapolated\": \"true\""),
+            std::string::npos);
+  EXPECT_EQ(json.find("\"lat\": 52.2572,"), std::string::npos);
+  clock.advance(now + std::chrono::seconds(30));
+  EXPECT_NE(contact.to_json(true).find("\"lat\": 52.2572,"),
+            std::string::npos);
+}
@@ -0,0 +1,181 @@
+#include "cpr.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "adsb_message.h"
+
+namespace {
+
+// from nl_transitions[n] on, there are 58 - n longitude zones
+constexpr std::array<double, 58> nl_transitions = {{
+    10.4704713000, 14.8281743687, 18.1862635707, 21.0293949260,
+    23.5450448656, 25.8292470706, 27.9389871012, 29.9113568573,
+    31.7720970768, 33.5399343630, 35.2289959780, 36.8502510759,
+    38.4124189241, 39.9225668433, 41.3865183226, 42.8091401224,
+    44.1945495142, 45.5462672266, 46.8673325250, 48.1603912810,
+    49.4277643926, 50.6715016555, 51.8934246917, 53.0951615280,
+    54.2781747227, 55.4437844450, 56.5931875621, 57.7274735387,
+    58.8476377615, 59.9545927669, 61.0491777425, 62.1321665921,
+    63.2042747938, 64.2661652257, 65.3184530968, 66.3617100838,
+    67.3964677408, 68.4232202208, 69.4424263114, 70.4545107499,
+    71.4598647303, 72.4588454473, 73.4517744167, 74.4389341573,
+    75.4205625665, 76.3968439079, 77.3678946133, 78.3337408292,
+    79.2942822546, 80.2492321328, 81.1980134927, 82.1395698051,
+    83.0719944472, 83.9917356298, 84.8916619070, 85.7554162094,
+    86.5353699751, 87.0000000000,
+}};
+
+// the table is indexed by quarter degrees, each of which contains at most one
+// transition (they are at least 0.46 degrees apart)
+constexpr int NL_BUCKETS_PER_DEGREE = 4;
+
+constexpr bool transitions_separated() {
+  for (size_t n = 1; n < nl_transitions.size(); n++) {
+    if (nl_transitions[n] - nl_transitions[n - 1] <=
+        1.0 / NL_BUCKETS_PER_DEGREE) {
+      return false;
+    }
+  }
+  return true;
+}
+static_assert(transitions_separated(), "more than one NL transition per bucket");
+
+struct NLBucket {
+  int nl;
+  // latitude within the bucket from which on NL is nl - 1
+  double transition;
+};
+
+constexpr std::array<NLBucket, 90 * NL_BUCKETS_PER_DEGREE> make_nl_buckets() {
+  std::array<NLBucket, 90 * NL_BUCKETS_PER_DEGREE> buckets = {};
+  size_t n = 0;
+  for (size_t bucket = 0; bucket < buckets.size(); bucket++) {
+    double start = static_cast<double>(bucket) / NL_BUCKETS_PER_DEGREE;
+    double end = static_cast<double>(bucket + 1) / NL_BUCKETS_PER_DEGREE;
+    while (n < nl_transitions.size() && nl_transitions[n] <= start) n++;
+    buckets[bucket].nl = 59 - static_cast<int>(n);
+    buckets[bucket].transition =
+        (n < nl_transitions.size() && nl_transitions[n] < end)
+            ? nl_transitions[n]
+            : 90.0;
+  }
+  return buckets;
+}
+
+constexpr std::array<NLBucket, 90 * NL_BUCKETS_PER_DEGREE> nl_buckets =
+    make_nl_buckets();
+
+static_assert(nl_buckets[0].nl == 59 && nl_buckets[41].nl == 59 &&
+                  nl_buckets[42].nl == 58 && nl_buckets[348].nl == 1,
+              "NL lookup table");
+
+}  // namespace
+
+int compute_NL(double lat) {
+  lat = std::abs(lat);
+  // also catches NaN
+  if (!(lat < nl_transitions.back())) return 1;
+  const NLBucket &bucket =
+      nl_buckets[static_cast<size_t>(lat * NL_BUCKETS_PER_DEGREE)];
+  return bucket.nl - (lat >= bucket.transition);
+}
+
+bool decode_cpr_global(double even_lat_cpr, double even_lon_cpr,
+                       double odd_lat_cpr, double odd_lon_cpr, bool odd_latest,
+                       bool surface, double lat_ref, double lon_ref,
+                       double *lat, double *lon) {
+  // calculate lat
+  int j = std::floor((59.0 * even_lat_cpr - 60 * odd_lat_cpr) + 0.5);
+  double lat_even = 6.0 * (pos_mod(j, 60) + even_lat_cpr);
+  double lat_odd = 360.0 / 59.0 * (pos_mod(j, 59) + odd_lat_cpr);
+  if (surface) {
+    lat_even = (lat_ref > 0) ? lat_even / 4.0 : lat_even / 4.0 - 90.0;
+    lat_odd = (lat_ref > 0) ? lat_odd / 4.0 : lat_odd / 4.0 - 90.0;
+  } else {
+    if (lat_even >= 270.0) lat_even -= 360.0;
+    if (lat_odd >= 270.0) lat_odd -= 360.0;
+  }
+
+  int NL_lat = compute_NL(lat_even);
+  if (NL_lat != compute_NL(lat_odd)) {
+    return false;
+  }
+  *lat = odd_latest ? lat_odd : lat_even;
+
+  // calculate lon
+  int m =
+      std::floor(even_lon_cpr * (NL_lat - 1.0) - odd_lon_cpr * NL_lat + 0.5);
+  int n_even = std::max(NL_lat, 1);
+  int n_odd = std::max(NL_lat - 1, 1);
+
+  double lon_even = 360.0 / n_even * (pos_mod(m, n_even) + even_lon_cpr);
+  double lon_odd = 360.0 / n_odd * (pos_mod(m, n_odd) + odd_lon_cpr);
+  if (surface) {
+    lon_even = lon_even / 4.0;
+    lon_odd = lon_odd / 4.0;
+  }
+  *lon = odd_latest ? lon_odd : lon_even;
+  if (surface) {
+    std::array<double, 4> lons = {*lon, *lon + 90, *lon + 180, *lon + 270};
+    for (double &val : lons) {
+      val = std::fmod(val + 180, 360) - 180;
+    }
+    double min_diff = std::abs(lon_ref - lons[0]);
+    size_t imin = 0;
+    for (size_t i = 1; i < lons.size(); ++i) {
+      double diff = std::abs(lon_ref - lons[i]);
+      if (diff < min_diff) {
+        min_diff = diff;
+        imin = i;
+      }
+    }
+    *lon = lons[imin];
+  } else {
+    if (*lon >= 180) *lon = *lon - 360;
+  }
+  return true;
+}
+
+void decode_cpr_local(double lat_cpr, double lon_cpr, int cpr_format,
+                      bool surface, double lat_ref, double lon_ref,
+                      double *lat, double *lon) {
+  double range = surface ? 90.0 : 360.0;
+  // without branches, apart from the NL lookup
+  double d_lat = range / (60 - cpr_format);
+  // zone index closest to the reference
+  double j = std::floor(lat_ref / d_lat) +
+             std::floor(0.5 +
+                        (lat_ref - d_lat * std::floor(lat_ref / d_lat)) /
+                            d_lat -
+                        lat_cpr);
+  *lat = d_lat * (j + lat_cpr);
+
+  double d_lon = range / std::max(compute_NL(*lat) - cpr_format, 1);
+  double m = std::floor(lon_ref / d_lon) +
+             std::floor(0.5 +
+                        (lon_ref - d_lon * std::floor(lon_ref / d_lon)) /
+                            d_lon -
+                        lon_cpr);
+  double lon_zone = d_lon * (m + lon_cpr);
+  // to [-180, 180)
+  *lon = lon_zone - 360.0 * std::floor((lon_zone + 180.0) / 360.0);
+}
+
+int pos_mod(int m, int n) {
+  int mod = m % n;
+  if (mod < 0) mod += n;
+  return mod;
+}
+
+double distance_nm(double lat_1, double lon_1, double lat_2, double lon_2) {
+  const double rad = M_PI / 180.0;
+  double d_lat = (lat_2 - lat_1) * rad;
+  double d_lon = (lon_2 - lon_1) * rad;
+  double a = std::sin(d_lat / 2) * std::sin(d_lat / 2) +
+             std::cos(lat_1 * rad) * std::cos(lat_2 * rad) *
+                 std::sin(d_lon / 2) * std::sin(d_lon / 2);
+  // mean earth radius of 3440.065 NM
+  return 2 * 3440.065 * std::asin(std::sqrt(std::min(a, 1.0)));
+}
@@ -0,0 +1,32 @@
+#ifndef ADSBOOST_CPR_H_
+#define ADSBOOST_CPR_H_
+
+// Compact Position Reporting. Airborne positions use zones over 360 degrees,
+// surface positions over 90 degrees, which are resolved relative to a
+// reference position.
+
+// Position from an even and an odd frame received a few seconds apart, the
+// more recent one determines the result. Returns false if the two frames lie
+// in different longitude zones.
+bool decode_cpr_global(double even_lat_cpr, double even_lon_cpr,
+                       double odd_lat_cpr, double odd_lon_cpr, bool odd_latest,
+                       bool surface, double lat_ref, double lon_ref,
+                       double *lat, double *lon);
+
+// Position from a single frame, unambiguous if the aircraft is within half a
+// zone of the reference, i.e. 180 NM (airborne) or 45 NM (surface) in
+// latitude.
+void decode_cpr_local(double lat_cpr, double lon_cpr, int cpr_format,
+                      bool surface, double lat_ref, double lon_ref,
+                      double *lat, double *lon);
+
+// number of longitude zones at the latitude
+int compute_NL(double lat);
+
+// m mod n in [0, n)
+int pos_mod(int m, int n);
+
+// great circle distance in nautical miles
+double distance_nm(double lat_1, double lon_1, double lat_2, double lon_2);
+
+#endif  // ADSBOOST_CPR_H_
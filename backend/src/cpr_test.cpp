@@ -0,0 +1,114 @@
+#include "cpr.h"
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "adsb_message.h"
+
+class CprTest : public ::testing::Test {
+ protected:
+  CprTest() {}
+};
+
+TEST_F(CprTest, CheckLocalAirbornePosition) {
+  std::array<unsigned char, 14> message = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                           0xc3, 0x82, 0xd6, 0x90, 0xc8,
+                                           0xac, 0x28, 0x63, 0xa7};
+  ADSBMessage msg = ADSBMessage(message);
+  EXPECT_EQ(msg.cpr_format, 0);
+  double lat, lon;
+  decode_cpr_local(msg.lat_cpr, msg.lon_cpr, msg.cpr_format, false, 52.258,
+                   3.918, &lat, &lon);
+  EXPECT_NEAR(lat, 52.25720, 1e-4);
+  EXPECT_NEAR(lon, 3.91937, 1e-4);
+  // anywhere within half a zone of the reference
+  decode_cpr_local(msg.lat_cpr, msg.lon_cpr, msg.cpr_format, false, 50.0,
+                   6.0, &lat, &lon);
+  EXPECT_NEAR(lat, 52.25720, 1e-4);
+  EXPECT_NEAR(lon, 3.91937, 1e-4);
+}
+
+TEST_F(CprTest, CheckLocalSurfacePosition) {
+  std::array<unsigned char, 14> message = {0x8c, 0x44, 0x0d, 0xa5, 0x38,
+                                           0x1f, 0x93, 0xa1, 0xc4, 0xcf,
+                                           0xf5, 0x8f, 0xe8, 0x76};
+  ADSBMessage msg = ADSBMessage(message);
+  double lat, lon;
+  decode_cpr_local(msg.lat_cpr, msg.lon_cpr, msg.cpr_format, true, 52.3,
+                   13.4, &lat, &lon);
+  EXPECT_NEAR(lat, 52.3620, 1e-3);
+  EXPECT_NEAR(lon, 13.5154, 1e-3);
+}
+
+TEST_F(CprTest, CheckGlobalMatchesLocal) {
+  std::array<unsigned char, 14> even = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                        0xc3, 0x82, 0xd6, 0x90, 0xc8,
+                                        0xac, 0x28, 0x63, 0xa7};
+  std::array<unsigned char, 14> odd = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                       0xc3, 0x86, 0x43, 0x5c, 0xc4,
+                                       0x12, 0x69, 0x2a, 0xd6};
+  ADSBMessage msg_even = ADSBMessage(even);
+  ADSBMessage msg_odd = ADSBMessage(odd);
+  double lat, lon, local_lat, local_lon;
+  ASSERT_TRUE(decode_cpr_global(msg_even.lat_cpr, msg_even.lon_cpr,
+                                msg_odd.lat_cpr, msg_odd.lon_cpr, false,
+                                false, 0, 0, &lat, &lon));
+  EXPECT_NEAR(lat, 52.25720, 1e-4);
+  EXPECT_NEAR(lon, 3.91937, 1e-4);
+  decode_cpr_local(msg_odd.lat_cpr, msg_odd.lon_cpr, 1, false, lat, lon,
+                   &local_lat, &local_lon);
+  ASSERT_TRUE(decode_cpr_global(msg_even.lat_cpr, msg_even.lon_cpr,
+                                msg_odd.lat_cpr, msg_odd.lon_cpr, true, false,
+                                0, 0, &lat, &lon));
+  EXPECT_NEAR(local_lat, lat, 1e-9);
+  EXPECT_NEAR(local_lon, lon, 1e-9);
+}
+
+TEST_F(CprTest, CheckDistance) {
+  EXPECT_NEAR(distance_nm(52.0, 13.0, 52.0, 13.0), 0, 1e-9);
+  // one minute of latitude is a nautical mile
+  EXPECT_NEAR(distance_nm(52.0, 13.0, 53.0, 13.0), 60.0, 0.1);
+}
+
+TEST_F(CprTest, CheckNLTable) {
+  EXPECT_EQ(compute_NL(0.0), 59);
+  EXPECT_EQ(compute_NL(10.4704712), 59);
+  EXPECT_EQ(compute_NL(10.4704713), 58);
+  EXPECT_EQ(compute_NL(-10.4704713), 58);
+  EXPECT_EQ(compute_NL(86.9999), 2);
+  EXPECT_EQ(compute_NL(87.0), 1);
+  EXPECT_EQ(compute_NL(90.0), 1);
+  // against the closed form, away from the transitions
+  for (double lat = -89.995; lat < 87.0; lat += 0.01) {
+    double a = 1 - std::cos(M_PI / 30);
+    double b = std::pow(std::cos(M_PI / 180 * lat), 2);
+    int nl = std::floor(2 * M_PI / std::acos(1 - a / b));
+    if (std::abs(lat) < 87.0) {
+      EXPECT_EQ(compute_NL(lat), nl) << lat;
+    }
+  }
+}
+
+TEST_F(CprTest, CheckLocalEvenAndOdd) {
+  std::array<unsigned char, 14> even = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                        0xc3, 0x82, 0xd6, 0x90, 0xc8,
+                                        0xac, 0x28, 0x63, 0xa7};
+  std::array<unsigned char, 14> odd = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                       0xc3, 0x86, 0x43, 0x5c, 0xc4,
+                                       0x12, 0x69, 0x2a, 0xd6};
+  ADSBMessage msg_even = ADSBMessage(even);
+  ADSBMessage msg_odd = ADSBMessage(odd);
+  std::array<double, 2> lat_cpr = {msg_even.lat_cpr, msg_odd.lat_cpr};
+  std::array<double, 2> lon_cpr = {msg_even.lon_cpr, msg_odd.lon_cpr};
+  std::array<int, 2> cpr_format = {0, 1};
+  std::array<double, 2> expected_lat = {52.2572, 52.2658};
+  std::array<double, 2> expected_lon = {3.9194, 3.9389};
+  for (size_t n = 0; n < 2; n++) {
+    double lat, lon;
+    decode_cpr_local(lat_cpr[n], lon_cpr[n], cpr_format[n], false, 52.0, 4.0,
+                     &lat, &lon);
+    EXPECT_NEAR(lat, expected_lat[n], 1e-4);
+    EXPECT_NEAR(lon, expected_lon[n], 1e-4);
+  }
+}
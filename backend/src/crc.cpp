@@ -0,0 +1,109 @@
+#include "crc.h"
+
+#include <algorithm>
+
+#include "adsb_message.h"
+
+uint32_t modes_checksum_table[112] = {
+    0x3935ea, 0x1c9af5, 0xf1b77e, 0x78dbbf, 0xc397db, 0x9e31e9, 0xb0e2f0,
+    0x587178, 0x2c38bc, 0x161c5e, 0x0b0e2f, 0xfa7d13, 0x82c48d, 0xbe9842,
+    0x5f4c21, 0xd05c14, 0x682e0a, 0x341705, 0xe5f186, 0x72f8c3, 0xc68665,
+    0x9cb936, 0x4e5c9b, 0xd8d449, 0x939020, 0x49c810, 0x24e408, 0x127204,
+    0x093902, 0x049c81, 0xfdb444, 0x7eda22, 0x3f6d11, 0xe04c8c, 0x702646,
+    0x381323, 0xe3f395, 0x8e03ce, 0x4701e7, 0xdc7af7, 0x91c77f, 0xb719bb,
+    0xa476d9, 0xadc168, 0x56e0b4, 0x2b705a, 0x15b82d, 0xf52612, 0x7a9309,
+    0xc2b380, 0x6159c0, 0x30ace0, 0x185670, 0x0c2b38, 0x06159c, 0x030ace,
+    0x018567, 0xff38b7, 0x80665f, 0xbfc92b, 0xa01e91, 0xaff54c, 0x57faa6,
+    0x2bfd53, 0xea04ad, 0x8af852, 0x457c29, 0xdd4410, 0x6ea208, 0x375104,
+    0x1ba882, 0x0dd441, 0xf91024, 0x7c8812, 0x3e4409, 0xe0d800, 0x706c00,
+    0x383600, 0x1c1b00, 0x0e0d80, 0x0706c0, 0x038360, 0x01c1b0, 0x00e0d8,
+    0x00706c, 0x003836, 0x001c1b, 0xfff409, 0x000000, 0x000000, 0x000000,
+    0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000,
+    0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000,
+    0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000};
+
+// CRC contribution of each value of each byte, combined from the per bit table
+struct CRCByteTable {
+  uint32_t table[14][256];
+  CRCByteTable() {
+    for (int byte = 0; byte < 14; byte++) {
+      for (int value = 0; value < 256; value++) {
+        uint32_t crc = 0;
+        for (int bit = 0; bit < 8; bit++) {
+          if (value & (1 << (7 - bit))) {
+            crc ^= modes_checksum_table[8 * byte + bit];
+          }
+        }
+        table[byte][value] = crc;
+      }
+    }
+  }
+};
+
+const CRCByteTable crc_byte_table;
+
+uint32_t calc_crc(std::array<unsigned char, 14> *msg, int n_bits) {
+  // short messages use the end of the table
+  int offset = (112 - n_bits) / 8;
+  uint32_t crc = 0;
+  for (int byte = 0; byte < n_bits / 8; byte++) {
+    crc ^= crc_byte_table.table[byte + offset][msg->at(byte)];
+  }
+  return crc; /* 24 bit checksum. */
+}
+
+uint32_t crc_syndrome(std::array<unsigned char, 14> *msg) {
+  int n_bits = message_bits(decode_downlink_format(*msg));
+  int n_bytes = n_bits / 8;
+  uint32_t checksum = msg->at(n_bytes - 3) << 16 |
+                      msg->at(n_bytes - 2) << 8 | msg->at(n_bytes - 1);
+  return calc_crc(msg, n_bits) ^ checksum;
+}
+
+bool check_crc(std::array<unsigned char, 14> *msg) {
+  return crc_syndrome(msg) == 0;
+}
+
+// change of the syndrome when flipping a single bit, either through the CRC
+// or through the transmitted checksum
+uint32_t bit_syndrome(int bit) {
+  if (bit < 88) {
+    return modes_checksum_table[bit];
+  }
+  return 1 << (111 - bit);
+}
+
+bool correct_low_confidence_bits(
+    std::array<unsigned char, 14> *msg,
+    const std::array<uint32_t, 112> &confidence, int max_bits) {
+  uint32_t syndrome = crc_syndrome(msg);
+  if (syndrome == 0) {
+    return true;
+  }
+  // the downlink format is never flipped, it was checked before
+  std::array<uint8_t, 107> bits;
+  for (int n = 0; n < 107; n++) {
+    bits[n] = n + 5;
+  }
+  int n_bits = std::clamp(max_bits, 0, MAX_CORRECTED_BITS);
+  std::partial_sort(bits.begin(), bits.begin() + n_bits, bits.end(),
+                    [&confidence](uint8_t a, uint8_t b) {
+                      return confidence[a] < confidence[b];
+                    });
+  // try every combination of the least confident bits
+  for (uint32_t flips = 1; flips < (1u << n_bits); flips++) {
+    uint32_t flipped = syndrome;
+    for (int n = 0; n < n_bits; n++) {
+      if (flips & (1u << n)) flipped ^= bit_syndrome(bits[n]);
+    }
+    if (flipped == 0) {
+      for (int n = 0; n < n_bits; n++) {
+        if (flips & (1u << n)) {
+          msg->at(bits[n] / 8) ^= 1 << (7 - bits[n] % 8);
+        }
+      }
+      return true;
+    }
+  }
+  return false;
+}
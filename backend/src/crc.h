@@ -0,0 +1,23 @@
+#ifndef ADSBOOST_CRC_H_
+#define ADSBOOST_CRC_H_
+
+#include <array>
+#include <cstdint>
+
+#include "config.h"
+
+// CRC of the first n_bits - 24 bits of a 56 or 112 bit message
+uint32_t calc_crc(std::array<unsigned char, 14> *msg, int n_bits = 112);
+// CRC of the message xor its parity field. Zero for a valid DF17/18 message,
+// the address for address/parity replies, the interrogator code for DF11.
+uint32_t crc_syndrome(std::array<unsigned char, 14> *msg);
+bool check_crc(std::array<unsigned char, 14> *msg);
+
+// Tries to repair a 112 bit message failing the CRC check by flipping
+// combinations of its max_bits least confident bits (up to
+// MAX_CORRECTED_BITS). Returns true if the message is valid afterwards.
+bool correct_low_confidence_bits(
+    std::array<unsigned char, 14> *msg,
+    const std::array<uint32_t, 112> &confidence, int max_bits);
+
+#endif  // ADSBOOST_CRC_H_
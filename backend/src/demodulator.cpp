@@ -4,101 +4,381 @@
 #include <cmath>
 #include <cstdint>
 #include <iostream>
+#include <utility>
 
 #include "adsb_message.h"
+#include "frame_view.h"
 
-Demodulator::Demodulator() {
-  for (int i = 0; i <= 128; i++) {
-    for (int q = 0; q <= 128; q++) {
-      magnitude_lookup[i * 129 + q] =
-          std::round(std::sqrt(i * i + q * q) * 360);
+Demodulator::Demodulator(int sample_frequency)
+    : Demodulator(DemodulatorSettings{.sample_rate = sample_frequency}) {}
+
+Demodulator::Demodulator(const DemodulatorSettings &settings)
+    : Demodulator(settings, std::make_shared<IcaoFilter>()) {}
+
+Demodulator::Demodulator(const DemodulatorSettings &settings,
+                         std::shared_ptr<IcaoFilter> icao_filter)
+    : icao_filter(std::move(icao_filter)) {
+  sample_frequency = settings.sample_rate;
+  preamble_threshold_db = settings.preamble_threshold_db;
+  max_corrected_bits = settings.max_corrected_bits;
+  detector = make_preamble_detector(settings.detector);
+  build_magnitude_table(IQEstimate());
+}
+
+void Demodulator::build_magnitude_table(const IQEstimate &estimate) {
+  for (int i = 0; i < 256; i++) {
+    for (int q = 0; q < 256; q++) {
+      double i_value = i - estimate.dc_i;
+      double q_value = (q - estimate.dc_q) * estimate.gain_q;
+      magnitude_table[i << 8 | q] = std::min(
+          65535.0,
+          std::round(std::sqrt(i_value * i_value + q_value * q_value) * 360));
     }
   }
+  table_estimate = estimate;
 }
-uint32_t modes_checksum_table[112] = {
-    0x3935ea, 0x1c9af5, 0xf1b77e, 0x78dbbf, 0xc397db, 0x9e31e9, 0xb0e2f0,
-    0x587178, 0x2c38bc, 0x161c5e, 0x0b0e2f, 0xfa7d13, 0x82c48d, 0xbe9842,
-    0x5f4c21, 0xd05c14, 0x682e0a, 0x341705, 0xe5f186, 0x72f8c3, 0xc68665,
-    0x9cb936, 0x4e5c9b, 0xd8d449, 0x939020, 0x49c810, 0x24e408, 0x127204,
-    0x093902, 0x049c81, 0xfdb444, 0x7eda22, 0x3f6d11, 0xe04c8c, 0x702646,
-    0x381323, 0xe3f395, 0x8e03ce, 0x4701e7, 0xdc7af7, 0x91c77f, 0xb719bb,
-    0xa476d9, 0xadc168, 0x56e0b4, 0x2b705a, 0x15b82d, 0xf52612, 0x7a9309,
-    0xc2b380, 0x6159c0, 0x30ace0, 0x185670, 0x0c2b38, 0x06159c, 0x030ace,
-    0x018567, 0xff38b7, 0x80665f, 0xbfc92b, 0xa01e91, 0xaff54c, 0x57faa6,
-    0x2bfd53, 0xea04ad, 0x8af852, 0x457c29, 0xdd4410, 0x6ea208, 0x375104,
-    0x1ba882, 0x0dd441, 0xf91024, 0x7c8812, 0x3e4409, 0xe0d800, 0x706c00,
-    0x383600, 0x1c1b00, 0x0e0d80, 0x0706c0, 0x038360, 0x01c1b0, 0x00e0d8,
-    0x00706c, 0x003836, 0x001c1b, 0xfff409, 0x000000, 0x000000, 0x000000,
-    0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000,
-    0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000,
-    0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000, 0x000000};
-
-uint32_t calc_crc(std::array<unsigned char, 14> *msg) {
-  uint32_t crc = 0;
-  int j;
 
-  for (j = 0; j < 112; j++) {
-    int byte = j / 8;
-    int bit = j % 8;
-    int bitmask = 1 << (7 - bit);
+// value below which the fraction p of the histogram lies, interpolated
+// within the bin of width 1 around each byte value
+double histogram_quantile(const std::array<uint32_t, 256> &histogram,
+                          double total, double p) {
+  double target = p * total;
+  double cumulative = 0;
+  for (int value = 0; value < 256; value++) {
+    if (histogram[value] > 0 && cumulative + histogram[value] >= target) {
+      return value - 0.5 + (target - cumulative) / histogram[value];
+    }
+    cumulative += histogram[value];
+  }
+  return 255;
+}
 
-    /* If bit is set, xor with corresponding table entry. */
-    if (msg->at(byte) & bitmask) crc ^= modes_checksum_table[j];
+void IQEstimate::update(const unsigned char *data, size_t len) {
+  // Median and interquartile range of the byte values, which are not moved
+  // by the few samples carrying a signal.
+  std::array<uint32_t, 256> histogram_i{};
+  std::array<uint32_t, 256> histogram_q{};
+  size_t n_used = 0;
+  for (size_t n = 0; n + 1 < len; n += 2 * IQ_ESTIMATE_STRIDE) {
+    histogram_i[data[n]]++;
+    histogram_q[data[n + 1]]++;
+    n_used++;
+  }
+  if (n_used < 100) {
+    return;
+  }
+  double buffer_dc_i = histogram_quantile(histogram_i, n_used, 0.5);
+  double buffer_dc_q = histogram_quantile(histogram_q, n_used, 0.5);
+  // interquartile range of a normal distribution is 1.349 sigma
+  double buffer_rms_i = (histogram_quantile(histogram_i, n_used, 0.75) -
+                         histogram_quantile(histogram_i, n_used, 0.25)) /
+                        1.349;
+  double buffer_rms_q = (histogram_quantile(histogram_q, n_used, 0.75) -
+                         histogram_quantile(histogram_q, n_used, 0.25)) /
+                        1.349;
+  // moving average over buffers, like the noise floor
+  double weight = n_updates == 0 ? 1 : 0.1;
+  dc_i = (1 - weight) * dc_i + weight * buffer_dc_i;
+  dc_q = (1 - weight) * dc_q + weight * buffer_dc_q;
+  rms_i = (1 - weight) * rms_i + weight * buffer_rms_i;
+  rms_q = (1 - weight) * rms_q + weight * buffer_rms_q;
+  // no imbalance can be seen without noise on both
+  if (rms_i >= 1 && rms_q >= 1) {
+    gain_q = std::clamp(rms_i / rms_q, 0.8, 1.25);
   }
-  return crc; /* 24 bit checksum. */
+  n_updates++;
 }
 
-bool check_crc(std::array<unsigned char, 14> *msg) {
-  uint32_t crc = calc_crc(msg);
-  uint32_t checksum = msg->at(11) << 16 | msg->at(12) << 8 | msg->at(13);
-  return crc == checksum;
+double magnitude_to_dbfs(double magnitude) {
+  // clamp to the smallest non-zero magnitude to stay finite
+  return 20 * std::log10(std::max(magnitude, 1.0) / (MAGNITUDE_FULL_SCALE));
+}
+
+DemodulatorStats &DemodulatorStats::operator+=(
+    const DemodulatorStats &other) {
+  candidates += other.candidates;
+  below_noise += other.below_noise;
+  sliced += other.sliced;
+  decoded += other.decoded;
+  duplicates += other.duplicates;
+  corrected += other.corrected;
+  unconfirmed += other.unconfirmed;
+  return *this;
+}
+
+void DemodulatorStats::print(std::ostream &out) {
+  out << "Preamble candidates: " << candidates
+      << ", rejected below noise: " << below_noise << ", sliced: " << sliced
+      << ", decoded: " << decoded << " (corrected: " << corrected
+      << "), duplicates: " << duplicates
+      << ", unconfirmed address/parity: " << unconfirmed << std::endl;
+}
+
+ADSBMessage decode_raw_message(const rawMessage &raw_message,
+                               const StreamClock &stream_clock) {
+  ADSBMessage msg =
+      ADSBMessage(raw_message.bytes,
+                  stream_clock.to_time(raw_message.sample_index),
+                  stream_clock.to_ticks(raw_message.sample_index));
+  msg.signal_status = KNOWN;
+  msg.rssi = raw_message.rssi;
+  msg.noise = raw_message.noise;
+  return msg;
 }
 
 void Demodulator::Demodulate(
     std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP> *buffer,
     uint32_t len, std::vector<std::array<unsigned char, 14>> *messages) {
+  std::vector<rawMessage> raw_messages;
+  // buffers are independent of each other here
+  last_frame_end = 0;
+  this->Demodulate(buffer, len, 0, &raw_messages);
+  for (const rawMessage &raw_message : raw_messages) {
+    messages->push_back(raw_message.bytes);
+  }
+}
+
+void Demodulator::Demodulate(
+    std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP> *buffer,
+    uint32_t len, int64_t sample_offset, std::vector<rawMessage> *messages) {
   std::array<u_int16_t, (BUFFER_LEN + BUFFER_OVERLAP) / 2> magnitudes;
 
   size_t data_len = std::min(BUFFER_LEN + BUFFER_OVERLAP, (int)len);
+  if (data_len < 2) {
+    return;
+  }
+  const unsigned char *data = buffer->data();
+  if (iq_correction) {
+    // the table is only rebuilt when the estimate drifted
+    iq_estimate.update(data, data_len);
+    if (std::abs(iq_estimate.dc_i - table_estimate.dc_i) > 0.25 ||
+        std::abs(iq_estimate.dc_q - table_estimate.dc_q) > 0.25 ||
+        std::abs(iq_estimate.gain_q - table_estimate.gain_q) > 0.01) {
+      build_magnitude_table(iq_estimate);
+    }
+  }
   // Calculate magnitudes
+  uint64_t magnitude_sum = 0;
   for (size_t n = 0; n < data_len; n += 2) {
-    int i = std::abs(buffer->at(n) - 127);
-    int q = std::abs(buffer->at(n + 1) - 127);
-    magnitudes[n / 2] = magnitude_lookup[i * 129 + q];
-  }
-  for (size_t n = 0; n < data_len / 2 - 239; n++) {
-    if (!(magnitudes[n] > magnitudes[n + 1] &&
-          magnitudes[n + 1] < magnitudes[n + 2] &&
-          magnitudes[n + 2] > magnitudes[n + 3] &&
-          magnitudes[n + 3] < magnitudes[n] &&
-          magnitudes[n + 4] < magnitudes[n] &&
-          magnitudes[n + 5] < magnitudes[n] &&
-          magnitudes[n + 6] < magnitudes[n] &&
-          magnitudes[n + 7] > magnitudes[n + 8] &&
-          magnitudes[n + 8] < magnitudes[n + 9] &&
-          magnitudes[n + 9] > magnitudes[n + 6])) {
+    magnitudes[n / 2] = magnitude_table[data[n] << 8 | data[n + 1]];
+    magnitude_sum += magnitudes[n / 2];
+  }
+  double buffer_magnitude = magnitude_sum / (data_len / 2.0);
+  buffer_noise = magnitude_to_dbfs(buffer_magnitude);
+  if (noise_magnitude == 0) {
+    noise_magnitude = buffer_magnitude;
+  } else {
+    noise_magnitude = 0.9 * noise_magnitude + 0.1 * buffer_magnitude;
+  }
+  noise_floor = magnitude_to_dbfs(noise_magnitude);
+  // minimum mean magnitude of the four preamble pulses
+  double min_pulse = noise_magnitude * std::pow(10, preamble_threshold_db / 20);
+
+  switch (sample_frequency) {
+    case 2400000:
+      DemodulateKernel<12, 5>(magnitudes.data(), data_len / 2, sample_offset,
+                              min_pulse, messages);
+      break;
+    case 8000000:
+      DemodulateKernel<8, 1>(magnitudes.data(), data_len / 2, sample_offset,
+                             min_pulse, messages);
+      break;
+    default:
+      DemodulateKernel<2, 1>(magnitudes.data(), data_len / 2, sample_offset,
+                             min_pulse, messages);
+  }
+}
+
+bool is_supported_sample_rate(int sample_rate) {
+  return sample_rate == 2000000 || sample_rate == 2400000 ||
+         sample_rate == 8000000;
+}
+
+DetectorType parse_detector_type(const std::string &name) {
+  if (name == "comparator") {
+    return COMPARATOR_DETECTOR;
+  }
+  if (name == "correlator") {
+    return CORRELATION_DETECTOR;
+  }
+  return UNKNOWN_DETECTOR;
+}
+
+std::unique_ptr<PreambleDetector> make_preamble_detector(DetectorType type) {
+  if (type == CORRELATION_DETECTOR) {
+    return std::make_unique<CorrelationDetector>();
+  }
+  return std::make_unique<ComparatorDetector>();
+}
+
+void ComparatorDetector::detect(const uint32_t *chips, size_t n_starts,
+                                size_t chip_units, uint32_t min_high,
+                                std::vector<size_t> *candidates,
+                                DemodulatorStats *stats) {
+  for (size_t start = 0; start < n_starts; start++) {
+    auto chip = [chips, start, chip_units](size_t n_chip) {
+      return chips[start + n_chip * chip_units];
+    };
+    uint32_t chip_0 = chip(0);
+    uint32_t chip_6 = chip(6);
+    if (!(chip_0 > chip(1) && chip(1) < chip(2) && chip(2) > chip(3) &&
+          chip(3) < chip_0 && chip(4) < chip_0 && chip(5) < chip_0 &&
+          chip_6 < chip_0 && chip(7) > chip(8) && chip(8) < chip(9) &&
+          chip(9) > chip_6)) {
       continue;
     }
-    uint32_t high = magnitudes[n] + magnitudes[n + 2] + magnitudes[n + 7] +
-                    magnitudes[n + 9];
+    stats->candidates++;
+    uint32_t high = chip_0 + chip(2) + chip(7) + chip(9);
+    if (high < min_high) {
+      stats->below_noise++;
+      continue;
+    }
+
+    if ((chip(4) >= high) || (chip(5) >= high)) {
+      continue;
+    }
+    if ((chip(11) >= high) || (chip(12) >= high) || (chip(13) >= high) ||
+        (chip(14) >= high)) {
+      continue;
+    }
+    candidates->push_back(start);
+  }
+}
+
+void CorrelationDetector::detect(const uint32_t *chips, size_t n_starts,
+                                 size_t chip_units, uint32_t min_high,
+                                 std::vector<size_t> *candidates,
+                                 DemodulatorStats *stats) {
+  // Plain multiply-adds over consecutive starts, which the compiler can
+  // vectorize. The weights sum to zero, so a flat signal correlates to 0.
+  constexpr int32_t weights[16] = {3,  -1, 3,  -1, -1, -1, -1, 3,
+                                   -1, 3,  -1, -1, -1, -1, -1, -1};
+  correlation.resize(n_starts);
+  for (size_t start = 0; start < n_starts; start++) {
+    int32_t sum = 0;
+    for (size_t n_chip = 0; n_chip < 16; n_chip++) {
+      sum += weights[n_chip] * int32_t(chips[start + n_chip * chip_units]);
+    }
+    correlation[start] = sum;
+  }
 
-    if ((magnitudes[n + 4] >= high) || (magnitudes[n + 5] >= high)) {
+  for (size_t start = 0; start < n_starts; start++) {
+    int32_t value = correlation[start];
+    if (value <= 0) {
+      continue;
+    }
+    if ((start > 0 && correlation[start - 1] > value) ||
+        (start + 1 < n_starts && correlation[start + 1] >= value)) {
+      continue;
+    }
+    // relative to the local energy, which does not depend on the gain
+    uint32_t energy = 0;
+    for (size_t n_chip = 0; n_chip < 16; n_chip++) {
+      energy += chips[start + n_chip * chip_units];
+    }
+    if (value < min_correlation * energy) {
       continue;
     }
-    if ((magnitudes[n + 11] >= high) || (magnitudes[n + 12] >= high) ||
-        (magnitudes[n + 13] >= high) || (magnitudes[n + 14] >= high)) {
+    stats->candidates++;
+    uint32_t high = chips[start] + chips[start + 2 * chip_units] +
+                    chips[start + 7 * chip_units] +
+                    chips[start + 9 * chip_units];
+    if (high < min_high) {
+      stats->below_noise++;
       continue;
     }
-    std::array<unsigned char, 14> message;
+    candidates->push_back(start);
+  }
+}
+
+template <int NUM, int DEN>
+void Demodulator::DemodulateKernel(const uint16_t *magnitudes,
+                                   size_t n_samples, int64_t sample_offset,
+                                   double min_pulse,
+                                   std::vector<rawMessage> *messages) {
+  // A chip spans NUM / 2 units of 1/DEN samples, a long frame 240 chips. The
+  // frame start is searched in these units, so for non-integer samples per
+  // chip every sub-sample phase is tried.
+  constexpr size_t chip_units = NUM / 2;
+  constexpr size_t frame_units = 240 * chip_units;
+  size_t n_units = n_samples * DEN;
+  if (n_units < frame_units) {
+    return;
+  }
+  // Energy of the chip starting at each unit as a sliding sum. Samples only
+  // partially covered by a chip are weighted by their coverage.
+  size_t n_chips = n_units - chip_units + 1;
+  chips.resize(n_chips);
+  uint32_t energy = 0;
+  for (size_t unit = 0; unit < chip_units; unit++) {
+    energy += magnitudes[unit / DEN];
+  }
+  chips[0] = energy;
+  for (size_t unit = 1; unit < n_chips; unit++) {
+    energy += magnitudes[(unit + chip_units - 1) / DEN];
+    energy -= magnitudes[(unit - 1) / DEN];
+    chips[unit] = energy;
+  }
+  // energies are sums over chip_units
+  uint32_t min_high = 4 * min_pulse * chip_units;
+  uint32_t min_delta = 255 * chip_units;
+  size_t n_starts = n_units - frame_units + 1;
+  candidates.clear();
+  detector->detect(chips.data(), n_starts, chip_units, min_high, &candidates,
+                   &stats);
+
+  // units before the stream start are skipped
+  size_t next_start = sample_offset < 0 ? -sample_offset * DEN : 0;
+  for (size_t start : candidates) {
+    if (start < next_start) {
+      // inside the last decoded frame
+      continue;
+    }
+    auto chip = [this, &start](size_t n_chip) {
+      return chips[start + n_chip * chip_units];
+    };
+    // With several units per chip the candidate can be found before the
+    // pulses are fully inside their chips. Move to the start within the next
+    // chip where the pulses stand out most against the gaps next to them.
+    if constexpr (chip_units > 1) {
+      auto score = [&chip]() {
+        return int64_t(chip(0)) + chip(2) + chip(7) + chip(9) - chip(1) -
+               chip(3) - chip(6) - chip(8);
+      };
+      size_t candidate = start;
+      int64_t best_score = score();
+      size_t best = start;
+      for (start = candidate + 1;
+           start < candidate + chip_units && start < n_starts; start++) {
+        int64_t next_score = score();
+        if (next_score > best_score) {
+          best_score = next_score;
+          best = start;
+        }
+      }
+      start = best;
+    }
+
+    stats.sliced++;
+    // short frames leave the last 7 bytes empty
+    std::array<unsigned char, 14> message{};
+    // difference between the two halves of each bit
+    std::array<uint32_t, 112> confidence;
     bool error = false;
-    for (int n_byte = 0; n_byte < 14; n_byte++) {
+    uint32_t signal_sum = 0;
+    uint32_t noise_sum = 0;
+    int n_bytes = 14;
+    for (int n_byte = 0; n_byte < n_bytes; n_byte++) {
       unsigned char byte = 0;
       for (int n_bit = 0; n_bit < 8; n_bit++) {
         int i = 8 * n_byte + n_bit;
-        uint16_t low = magnitudes[n + 2 * i + 16];
-        uint16_t high = magnitudes[n + 2 * i + 16 + 1];
-        uint32_t delta = std::abs(low - high);
-        if (i > 0 && delta < 255) {
+        uint32_t low = chip(2 * i + 16);
+        uint32_t high = chip(2 * i + 16 + 1);
+        uint32_t delta = low > high ? low - high : high - low;
+        confidence[i] = delta;
+        signal_sum += std::max(low, high);
+        noise_sum += std::min(low, high);
+        if (i > 0 && delta < min_delta) {
           if (n_bit == 0) {
             byte = byte | ((message[n_byte - 1] & 1) << 7);
           } else {
@@ -111,18 +391,62 @@ void Demodulator::Demodulate(
         }
       }
       message[n_byte] = byte;
+      if (n_byte == 0) {
+        // the downlink format gives the length of the frame
+        n_bytes = message_bits(byte >> 3) / 8;
+      }
     }
     if (error) {
       continue;
     }
 
-    // Only ADS-B messages for now
-    int downlink_format = message[0] >> 3;
-    if (!(downlink_format == 17 || downlink_format == 18)) {
+    FrameView frame(message);
+    int downlink_format = frame.downlink_format();
+    if (!(is_tracked_format(downlink_format) || downlink_format == 18)) {
       continue;
     }
-    if (check_crc(&message)) {
-      messages->push_back(message);
+    uint64_t sample_index = sample_offset + start / DEN;
+    double stream_time = double(sample_index) / sample_frequency;
+    if (downlink_format == 17 || downlink_format == 18) {
+      if (!check_crc(&message)) {
+        if (!correct_low_confidence_bits(&message, confidence,
+                                         max_corrected_bits)) {
+          continue;
+        }
+        stats.corrected++;
+      }
+      // DF18 only carries an ICAO address with CF 0
+      if (downlink_format == 17 || frame.capability() == 0) {
+        icao_filter->add(frame.address(), stream_time);
+      }
+    } else if (downlink_format == 11) {
+      // the parity is overlaid with the interrogator code, 0 for replies
+      // to spontaneous acquisition squitters
+      uint32_t syndrome = crc_syndrome(&message);
+      if (syndrome & ~0x7Fu) {
+        continue;
+      }
+      if (syndrome == 0) {
+        icao_filter->add(frame.address(), stream_time);
+      }
+    } else if (!icao_filter->contains(crc_syndrome(&message), stream_time)) {
+      // address/parity reply from an unknown address, most likely corrupt
+      stats.unconfirmed++;
+      continue;
+    }
+
+    size_t message_units = (16 + 2 * 8 * n_bytes) * chip_units;
+    if (sample_index < last_frame_end) {
+      stats.duplicates++;
+    } else {
+      stats.decoded++;
+      messages->push_back(
+          {message, sample_index,
+           magnitude_to_dbfs(signal_sum / (8.0 * n_bytes * chip_units)),
+           magnitude_to_dbfs(noise_sum / (8.0 * n_bytes * chip_units))});
+      last_frame_end = sample_offset + (start + message_units) / DEN;
     }
+    // continue after the frame, there is no other preamble inside
+    next_start = start + message_units;
   }
 }
@@ -3,26 +3,175 @@
 
 #include <array>
 #include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
 #include <vector>
 
+#include "adsb_message.h"
+#include "clock.h"
 #include "config.h"
+#include "crc.h"
+#include "icao_filter.h"
 
 struct rawMessage {
-  std::array<char, 14> bytes;
+  std::array<unsigned char, 14> bytes;
+  // absolute sample index of the preamble in the stream
+  uint64_t sample_index = 0;
+  // mean magnitude of the pulses and of the empty half bits in dBFS
+  double rssi = 0;
+  double noise = 0;
 };
 
-uint32_t calc_crc(std::array<unsigned char, 14> *msg);
-bool check_crc(std::array<unsigned char, 14> *msg);
+// full scale of the magnitude lookup, |i| = 128 and q = 0
+#define MAGNITUDE_FULL_SCALE 128 * 360
+
+double magnitude_to_dbfs(double magnitude);
+
+// 2, 2.4 and 8 MSPS
+bool is_supported_sample_rate(int sample_rate);
+
+struct DemodulatorStats {
+  // preambles passing the shape test
+  uint64_t candidates = 0;
+  // candidates with pulses too weak compared to the noise floor
+  uint64_t below_noise = 0;
+  // candidates going through bit slicing and CRC check
+  uint64_t sliced = 0;
+  uint64_t decoded = 0;
+  // frames already emitted from the overlap of the previous buffer
+  uint64_t duplicates = 0;
+  // decoded frames repaired by flipping low confidence bits
+  uint64_t corrected = 0;
+  // address/parity replies dropped as their address was not confirmed
+  uint64_t unconfirmed = 0;
+
+  DemodulatorStats &operator+=(const DemodulatorStats &other);
+  void print(std::ostream &out);
+};
+
+enum DetectorType {
+  COMPARATOR_DETECTOR,
+  CORRELATION_DETECTOR,
+  UNKNOWN_DETECTOR
+};
+
+// "comparator" or "correlator"
+DetectorType parse_detector_type(const std::string &name);
+
+// Finds preamble candidates in a buffer. Positions are counted in units of
+// 1/DEN samples and chips[u] is the energy of the chip (0.5 us) starting at
+// unit u, so the preamble chips of a frame starting at u are
+// chips[u + k * chip_units]. Candidates are appended in increasing order.
+class PreambleDetector {
+ public:
+  virtual ~PreambleDetector() = default;
+  // min_high is the minimum energy of the four preamble pulses
+  virtual void detect(const uint32_t *chips, size_t n_starts, size_t chip_units,
+                      uint32_t min_high, std::vector<size_t> *candidates,
+                      DemodulatorStats *stats) = 0;
+};
+
+// Chain of comparisons between the preamble chips.
+class ComparatorDetector : public PreambleDetector {
+ public:
+  void detect(const uint32_t *chips, size_t n_starts, size_t chip_units,
+              uint32_t min_high, std::vector<size_t> *candidates,
+              DemodulatorStats *stats) override;
+};
+
+// Correlates the chips with the preamble template, pulses weighted 3 and the
+// other 12 chips -1, and takes local maxima where the correlation reaches
+// min_correlation times the energy of the 16 chips.
+class CorrelationDetector : public PreambleDetector {
+ public:
+  double min_correlation = 1.0;
+  void detect(const uint32_t *chips, size_t n_starts, size_t chip_units,
+              uint32_t min_high, std::vector<size_t> *candidates,
+              DemodulatorStats *stats) override;
+
+ private:
+  std::vector<int32_t> correlation;
+};
+
+std::unique_ptr<PreambleDetector> make_preamble_detector(DetectorType type);
+
+// Running estimate of the DC offset of I and Q and of their gain imbalance,
+// from the median and spread of every IQ_ESTIMATE_STRIDE-th sample of each
+// buffer.
+struct IQEstimate {
+  double dc_i = 127;
+  double dc_q = 127;
+  double rms_i = 0;
+  double rms_q = 0;
+  // applied to Q to match the gain of I
+  double gain_q = 1;
+  uint64_t n_updates = 0;
+
+  void update(const unsigned char *data, size_t len);
+};
+
+// Options of a Demodulator which can be set from the command line.
+struct DemodulatorSettings {
+  int sample_rate = SAMPLE_RATE;
+  double preamble_threshold_db = PREAMBLE_THRESHOLD_DB;
+  int max_corrected_bits = CORRECTED_BITS;
+  DetectorType detector = COMPARATOR_DETECTOR;
+};
+
+// Decodes a demodulated frame, timed by its sample index in the stream.
+ADSBMessage decode_raw_message(const rawMessage &raw_message,
+                               const StreamClock &stream_clock);
 
 class Demodulator {
  public:
   int sample_frequency;
-  std::array<uint16_t, 129 * 129 * 2> magnitude_lookup;
+  // magnitude of each raw I/Q byte pair, index I << 8 | Q, corrected for the
+  // DC offset and gain imbalance in table_estimate
+  std::array<uint16_t, 256 * 256> magnitude_table;
+  bool iq_correction = true;
+  IQEstimate iq_estimate;
+  IQEstimate table_estimate;
+  // mean magnitude of the last buffer and its moving average over buffers,
+  // in dBFS. Frames are rare enough for this to estimate the noise floor.
+  double buffer_noise = 0;
+  double noise_floor = 0;
+  double noise_magnitude = 0;
+  double preamble_threshold_db = PREAMBLE_THRESHOLD_DB;
+  // number of least confident bits tried when the CRC check fails
+  int max_corrected_bits = CORRECTED_BITS;
+  DemodulatorStats stats;
+  // absolute sample index following the last emitted frame. Frames starting
+  // before it were already emitted from the previous buffer.
+  uint64_t last_frame_end = 0;
+  std::unique_ptr<PreambleDetector> detector;
+  // can be shared by demodulators of the same stream
+  std::shared_ptr<IcaoFilter> icao_filter;
+
+  explicit Demodulator(int sample_frequency = SAMPLE_RATE);
+  explicit Demodulator(const DemodulatorSettings &settings);
+  // with a filter shared with other demodulators instead of an own one
+  Demodulator(const DemodulatorSettings &settings,
+              std::shared_ptr<IcaoFilter> icao_filter);
+  void Demodulate(
+      std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP> *buffer,
+      uint32_t len, std::vector<std::array<unsigned char, 14>> *messages);
+  // sample_offset is the absolute sample index of buffer->at(0). It is
+  // negative for the first buffer of a stream, whose overlap holds no samples.
+  void Demodulate(
+      std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP> *buffer,
+      uint32_t len, int64_t sample_offset, std::vector<rawMessage> *messages);
+  void build_magnitude_table(const IQEstimate &estimate);
 
-  Demodulator();
-  void Demodulate(std::array<unsigned char, BUFFER_LEN + 480> *buffer,
-                  uint32_t len,
-                  std::vector<std::array<unsigned char, 14>> *messages);
+ private:
+  // Preamble search and bit slicing for NUM / DEN samples per microsecond.
+  template <int NUM, int DEN>
+  void DemodulateKernel(const uint16_t *magnitudes, size_t n_samples,
+                        int64_t sample_offset, double min_pulse,
+                        std::vector<rawMessage> *messages);
+  // reused across buffers
+  std::vector<uint32_t> chips;
+  std::vector<size_t> candidates;
 };
 
 #endif  // ADSBOOST_DEMODULATOR_H_
\ No newline at end of file
@@ -3,9 +3,12 @@
 #include <gtest/gtest.h>
 
 #include <algorithm>
+#include <cmath>
 #include <fstream>
+#include <memory>
 
 #include "adsb_message.h"
+#include "test/test_signal.h"
 #define BUFFER_LEN 16 * 16384
 
 const std::string test_data_path = "../test/data/";
@@ -75,4 +78,353 @@ TEST_F(DemodTest, CheckDemodulate) {
             "8f4d202358779451f985edf9f21e");
   EXPECT_EQ(ADSBMessage(messages[12]).HexString(),
             "8f4d2023991093ad087c133060d1");
-}
\ No newline at end of file
+}
+TEST_F(DemodTest, CheckDemodulateSampleIndex) {
+  std::array<unsigned char, 14> frame = {0x8d, 0x3c, 0x65, 0x85, 0x23,
+                                         0x10, 0xc2, 0x34, 0x04, 0x88,
+                                         0x20, 0x5a, 0x8f, 0xaf};
+  std::vector<unsigned char> iq = silent_iq((BUFFER_LEN + BUFFER_OVERLAP) / 2);
+  modulate_frame(&iq, 1000, frame);
+  modulate_frame(&iq, 50000, frame);
+  auto data =
+      std::make_unique<std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP>>();
+  std::copy(iq.begin(), iq.end(), data->begin());
+
+  std::vector<rawMessage> messages;
+  Demodulator demodulator = Demodulator();
+  demodulator.Demodulate(data.get(), data->size(), 7000000, &messages);
+  ASSERT_EQ(messages.size(), 2);
+  EXPECT_EQ(messages[0].bytes, frame);
+  EXPECT_EQ(messages[0].sample_index, 7001000);
+  EXPECT_EQ(messages[1].sample_index, 7050000);
+}
+
+TEST_F(DemodTest, CheckDemodulateSignalLevel) {
+  std::array<unsigned char, 14> frame = {0x8d, 0x3c, 0x65, 0x85, 0x23,
+                                         0x10, 0xc2, 0x34, 0x04, 0x88,
+                                         0x20, 0x5a, 0x8f, 0xaf};
+  std::vector<unsigned char> iq = silent_iq((BUFFER_LEN + BUFFER_OVERLAP) / 2);
+  // a strong and a 20 dB weaker frame
+  modulate_frame(&iq, 1000, frame, 120);
+  modulate_frame(&iq, 50000, frame, 12);
+  auto data =
+      std::make_unique<std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP>>();
+  std::copy(iq.begin(), iq.end(), data->begin());
+
+  std::vector<rawMessage> messages;
+  Demodulator demodulator = Demodulator();
+  demodulator.Demodulate(data.get(), data->size(), 0, &messages);
+  ASSERT_EQ(messages.size(), 2);
+  EXPECT_NEAR(messages[0].rssi, 20 * std::log10(120 / 128.0), 0.01);
+  EXPECT_NEAR(messages[1].rssi, 20 * std::log10(12 / 128.0), 0.01);
+  // no noise in the synthetic signal
+  EXPECT_EQ(messages[0].noise, magnitude_to_dbfs(0));
+  EXPECT_LT(demodulator.buffer_noise, messages[1].rssi);
+  EXPECT_EQ(demodulator.noise_floor, demodulator.buffer_noise);
+
+  ADSBMessage msg = decode_raw_message(messages[1], StreamClock());
+  EXPECT_EQ(msg.signal_status, KNOWN);
+  EXPECT_EQ(msg.rssi, messages[1].rssi);
+}
+
+TEST_F(DemodTest, CheckPreambleNoiseGate) {
+  std::array<unsigned char, 14> frame = {0x8d, 0x3c, 0x65, 0x85, 0x23,
+                                         0x10, 0xc2, 0x34, 0x04, 0x88,
+                                         0x20, 0x5a, 0x8f, 0xaf};
+  std::vector<unsigned char> iq = silent_iq((BUFFER_LEN + BUFFER_OVERLAP) / 2);
+  modulate_frame(&iq, 1000, frame, 100);
+  modulate_frame(&iq, 50000, frame, 30);
+  add_noise(&iq, 5);
+  auto data =
+      std::make_unique<std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP>>();
+  std::copy(iq.begin(), iq.end(), data->begin());
+
+  std::vector<rawMessage> messages;
+  Demodulator demodulator = Demodulator();
+  demodulator.Demodulate(data.get(), data->size(), 0, &messages);
+  EXPECT_EQ(messages.size(), 2);
+  EXPECT_EQ(demodulator.stats.decoded, 2);
+  EXPECT_GT(demodulator.stats.candidates, demodulator.stats.sliced);
+
+  // the weak frame is only ~18 dB above the mean noise magnitude
+  Demodulator gated = Demodulator();
+  gated.preamble_threshold_db = 20;
+  messages.clear();
+  gated.Demodulate(data.get(), data->size(), 0, &messages);
+  ASSERT_EQ(messages.size(), 1);
+  EXPECT_EQ(messages[0].sample_index, 1000);
+  EXPECT_GT(gated.stats.below_noise, demodulator.stats.below_noise);
+  EXPECT_LT(gated.stats.sliced, demodulator.stats.sliced);
+}
+
+TEST_F(DemodTest, CheckOverlapDuplicates) {
+  std::array<unsigned char, 14> frame = {0x8d, 0x40, 0x6b, 0x90, 0x20,
+                                         0x15, 0xa6, 0x78, 0xd4, 0xd2,
+                                         0x20, 0xaa, 0x4b, 0xda};
+  // two consecutive buffers, the second one starting with the overlap
+  std::vector<unsigned char> iq =
+      silent_iq(BUFFER_LEN + BUFFER_OVERLAP / 2);
+  // back to back frames
+  modulate_frame(&iq, 1000, frame);
+  modulate_frame(&iq, 1240, frame);
+  // frame within the overlap, it is seen by both buffers
+  modulate_frame(&iq, BUFFER_LEN / 2, frame);
+
+  auto data =
+      std::make_unique<std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP>>();
+  std::vector<rawMessage> messages;
+  Demodulator demodulator = Demodulator();
+  for (int n_buffer = 0; n_buffer < 2; n_buffer++) {
+    std::copy(iq.begin() + n_buffer * BUFFER_LEN,
+              iq.begin() + n_buffer * BUFFER_LEN + data->size(),
+              data->begin());
+    demodulator.Demodulate(data.get(), data->size(), n_buffer * BUFFER_LEN / 2,
+                           &messages);
+  }
+  ASSERT_EQ(messages.size(), 3);
+  EXPECT_EQ(messages[0].sample_index, 1000);
+  EXPECT_EQ(messages[1].sample_index, 1240);
+  EXPECT_EQ(messages[2].sample_index, BUFFER_LEN / 2);
+  EXPECT_EQ(demodulator.stats.decoded, 3);
+  EXPECT_EQ(demodulator.stats.duplicates, 1);
+}
+
+TEST_F(DemodTest, CheckFirstBufferPrefix) {
+  std::array<unsigned char, 14> frame = {0x8d, 0x40, 0x6b, 0x90, 0x20,
+                                         0x15, 0xa6, 0x78, 0xd4, 0xd2,
+                                         0x20, 0xaa, 0x4b, 0xda};
+  // the overlap of the first buffer lies before the stream start
+  std::vector<unsigned char> iq = silent_iq((BUFFER_LEN + BUFFER_OVERLAP) / 2);
+  modulate_frame(&iq, 100, frame);
+  modulate_frame(&iq, 2000, frame);
+
+  auto data =
+      std::make_unique<std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP>>();
+  std::copy(iq.begin(), iq.end(), data->begin());
+  std::vector<rawMessage> messages;
+  Demodulator demodulator = Demodulator();
+  demodulator.Demodulate(data.get(), data->size(), -BUFFER_OVERLAP / 2,
+                         &messages);
+  ASSERT_EQ(messages.size(), 1);
+  EXPECT_EQ(messages[0].sample_index, 2000 - BUFFER_OVERLAP / 2);
+}
+
+TEST_F(DemodTest, CheckDemodulateSampleRates) {
+  std::array<unsigned char, 14> frame = {0x8d, 0x3c, 0x65, 0x85, 0x23,
+                                         0x10, 0xc2, 0x34, 0x04, 0x88,
+                                         0x20, 0x5a, 0x8f, 0xaf};
+  // frame starts in between samples
+  std::vector<double> starts_us = {100, 1000.3, 5000.7, 5120.9};
+  for (int sample_rate : {2400000, 8000000}) {
+    std::vector<unsigned char> iq =
+        silent_iq((BUFFER_LEN + BUFFER_OVERLAP) / 2);
+    for (double start_us : starts_us) {
+      modulate_frame_at_rate(&iq, start_us, frame, sample_rate);
+    }
+    auto data = std::make_unique<
+        std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP>>();
+    std::copy(iq.begin(), iq.end(), data->begin());
+
+    std::vector<rawMessage> messages;
+    Demodulator demodulator = Demodulator(sample_rate);
+    demodulator.Demodulate(data.get(), data->size(), 0, &messages);
+    ASSERT_EQ(messages.size(), starts_us.size()) << sample_rate;
+    for (size_t n = 0; n < messages.size(); n++) {
+      EXPECT_EQ(messages[n].bytes, frame);
+      EXPECT_NEAR(messages[n].sample_index, starts_us[n] * sample_rate / 1e6,
+                  1.0);
+    }
+  }
+  EXPECT_FALSE(is_supported_sample_rate(3200000));
+}
+
+TEST_F(DemodTest, CheckCorrectLowConfidenceBits) {
+  std::array<unsigned char, 14> valid = {0x8d, 0x4d, 0x24, 0x08, 0x99,
+                                         0x08, 0xcb, 0x1b, 0xb8, 0x44,
+                                         0x1c, 0x46, 0xa9, 0x9b};
+  std::array<uint32_t, 112> confidence;
+  confidence.fill(1000);
+  // one error in the data, one in the parity bits
+  std::array<unsigned char, 14> message = valid;
+  message[5] ^= 0x10;
+  message[12] ^= 0x01;
+  EXPECT_NE(crc_syndrome(&message), 0);
+  confidence[8 * 5 + 3] = 10;
+  confidence[8 * 12 + 7] = 20;
+  confidence[30] = 30;
+
+  std::array<unsigned char, 14> corrected = message;
+  EXPECT_FALSE(correct_low_confidence_bits(&corrected, confidence, 1));
+  EXPECT_EQ(corrected, message);
+  EXPECT_TRUE(correct_low_confidence_bits(&corrected, confidence, 3));
+  EXPECT_EQ(corrected, valid);
+
+  // the wrong bits are not among the least confident ones
+  confidence[8 * 12 + 7] = 1000;
+  confidence[40] = 5;
+  corrected = message;
+  EXPECT_FALSE(correct_low_confidence_bits(&corrected, confidence, 3));
+  EXPECT_EQ(corrected, message);
+}
+
+TEST_F(DemodTest, CheckDemodulateCorrectsAmbiguousBits) {
+  std::array<unsigned char, 14> frame = {0x8d, 0x3c, 0x65, 0x85, 0x23,
+                                         0x10, 0xc2, 0x34, 0x04, 0x88,
+                                         0x20, 0x5a, 0x8f, 0xaf};
+  std::vector<unsigned char> iq = silent_iq((BUFFER_LEN + BUFFER_OVERLAP) / 2);
+  modulate_frame(&iq, 1000, frame);
+  // pulses in both halves of bits 40 (0) and 54 (1), which differ from the
+  // preceding bits, so the slicer gets them wrong
+  for (int bit : {40, 54}) {
+    write_chip(&iq, 1000 + 16 + 2 * bit, 100);
+    write_chip(&iq, 1000 + 16 + 2 * bit + 1, 100);
+  }
+  auto data =
+      std::make_unique<std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP>>();
+  std::copy(iq.begin(), iq.end(), data->begin());
+
+  std::vector<rawMessage> messages;
+  Demodulator uncorrected = Demodulator();
+  uncorrected.max_corrected_bits = 0;
+  uncorrected.Demodulate(data.get(), data->size(), 0, &messages);
+  EXPECT_EQ(messages.size(), 0);
+
+  Demodulator demodulator = Demodulator();
+  demodulator.Demodulate(data.get(), data->size(), 0, &messages);
+  ASSERT_EQ(messages.size(), 1);
+  EXPECT_EQ(messages[0].bytes, frame);
+  EXPECT_EQ(demodulator.stats.corrected, 1);
+}
+
+TEST_F(DemodTest, CheckCorrelationDetector) {
+  std::array<unsigned char, 14> frame = {0x8d, 0x3c, 0x65, 0x85, 0x23,
+                                         0x10, 0xc2, 0x34, 0x04, 0x88,
+                                         0x20, 0x5a, 0x8f, 0xaf};
+  std::vector<unsigned char> iq = silent_iq((BUFFER_LEN + BUFFER_OVERLAP) / 2);
+  modulate_frame(&iq, 1000, frame, 100);
+  modulate_frame(&iq, 50000, frame, 30);
+  // a pulse of another transmission within the preamble
+  modulate_frame(&iq, 90000, frame, 100);
+  write_chip(&iq, 90000 + 6, 110);
+  add_noise(&iq, 5);
+  auto data =
+      std::make_unique<std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP>>();
+  std::copy(iq.begin(), iq.end(), data->begin());
+
+  DemodulatorSettings settings;
+  std::vector<rawMessage> messages;
+  Demodulator comparator = Demodulator(settings);
+  comparator.Demodulate(data.get(), data->size(), 0, &messages);
+  ASSERT_EQ(messages.size(), 2);
+  EXPECT_EQ(messages[1].sample_index, 50000);
+
+  settings.detector = parse_detector_type("correlator");
+  ASSERT_EQ(settings.detector, CORRELATION_DETECTOR);
+  Demodulator correlator = Demodulator(settings);
+  messages.clear();
+  correlator.Demodulate(data.get(), data->size(), 0, &messages);
+  ASSERT_EQ(messages.size(), 3);
+  EXPECT_EQ(messages[0].sample_index, 1000);
+  EXPECT_EQ(messages[1].sample_index, 50000);
+  EXPECT_EQ(messages[2].sample_index, 90000);
+  // only local maxima of the correlation become candidates
+  EXPECT_LT(correlator.stats.candidates, comparator.stats.candidates);
+
+  for (int sample_rate : {2400000, 8000000}) {
+    std::vector<unsigned char> iq_rate =
+        silent_iq((BUFFER_LEN + BUFFER_OVERLAP) / 2);
+    modulate_frame_at_rate(&iq_rate, 1000.3, frame, sample_rate);
+    std::copy(iq_rate.begin(), iq_rate.end(), data->begin());
+    settings.sample_rate = sample_rate;
+    Demodulator demodulator = Demodulator(settings);
+    messages.clear();
+    demodulator.Demodulate(data.get(), data->size(), 0, &messages);
+    ASSERT_EQ(messages.size(), 1) << sample_rate;
+    EXPECT_NEAR(messages[0].sample_index, 1000.3 * sample_rate / 1e6, 1.0);
+  }
+  EXPECT_EQ(parse_detector_type("other"), UNKNOWN_DETECTOR);
+}
+
+TEST_F(DemodTest, CheckIQCorrection) {
+  std::array<unsigned char, 14> frame = {0x8d, 0x3c, 0x65, 0x85, 0x23,
+                                         0x10, 0xc2, 0x34, 0x04, 0x88,
+                                         0x20, 0x5a, 0x8f, 0xaf};
+  std::vector<unsigned char> signal =
+      silent_iq((BUFFER_LEN + BUFFER_OVERLAP) / 2);
+  modulate_frame(&signal, 1000, frame, 25);
+  // noise centred on 130/124 with 10% less gain on Q
+  std::mt19937 generator(1);
+  std::normal_distribution<double> distribution(0, 4);
+  std::vector<unsigned char> iq(signal.size());
+  for (size_t n = 0; n < iq.size(); n += 2) {
+    iq[n] = std::lround(3 + signal[n] + distribution(generator));
+    iq[n + 1] =
+        std::lround(-3 + signal[n + 1] + 0.9 * distribution(generator));
+  }
+  auto data =
+      std::make_unique<std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP>>();
+  std::copy(iq.begin(), iq.end(), data->begin());
+
+  std::vector<rawMessage> messages;
+  Demodulator uncorrected = Demodulator();
+  uncorrected.iq_correction = false;
+  uncorrected.Demodulate(data.get(), data->size(), 0, &messages);
+
+  Demodulator demodulator = Demodulator();
+  messages.clear();
+  demodulator.Demodulate(data.get(), data->size(), 0, &messages);
+  EXPECT_NEAR(demodulator.iq_estimate.dc_i, 130, 0.2);
+  EXPECT_NEAR(demodulator.iq_estimate.dc_q, 124, 0.2);
+  EXPECT_NEAR(demodulator.iq_estimate.gain_q, 1 / 0.9, 0.05);
+  EXPECT_EQ(demodulator.table_estimate.dc_i, demodulator.iq_estimate.dc_i);
+  // the offset no longer adds to the magnitudes
+  EXPECT_LT(demodulator.buffer_noise, uncorrected.buffer_noise - 1);
+  ASSERT_EQ(messages.size(), 1);
+  EXPECT_EQ(messages[0].bytes, frame);
+}
+
+TEST_F(DemodTest, CheckDemodulateShortReplies) {
+  std::array<unsigned char, 14> position = {0x8d, 0x3c, 0x65, 0x85, 0x23,
+                                            0x10, 0xc2, 0x34, 0x04, 0x88,
+                                            0x20, 0x5a, 0x8f, 0xaf};
+  // DF11 all-call reply with zero interrogator code
+  std::array<unsigned char, 14> all_call = {0x5d, 0x48, 0x40, 0xd6};
+  // DF4 altitude replies of the tracked and of an unseen aircraft
+  std::array<unsigned char, 14> known = {0x20, 0x00, 0x18, 0x38};
+  std::array<unsigned char, 14> unknown = known;
+  auto set_parity = [](std::array<unsigned char, 14> *msg, uint32_t address) {
+    uint32_t parity = calc_crc(msg, 56) ^ address;
+    (*msg)[4] = (parity >> 16) & 0xFF;
+    (*msg)[5] = (parity >> 8) & 0xFF;
+    (*msg)[6] = parity & 0xFF;
+  };
+  set_parity(&all_call, 0);
+  set_parity(&known, 0x3c6585);
+  set_parity(&unknown, 0xabcdef);
+
+  std::vector<unsigned char> iq = silent_iq((BUFFER_LEN + BUFFER_OVERLAP) / 2);
+  // the AP reply before the address is confirmed is dropped
+  modulate_frame(&iq, 1000, known, 100, 56);
+  modulate_frame(&iq, 2000, position);
+  modulate_frame(&iq, 3000, all_call, 100, 56);
+  modulate_frame(&iq, 4000, known, 100, 56);
+  modulate_frame(&iq, 5000, unknown, 100, 56);
+
+  auto data =
+      std::make_unique<std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP>>();
+  std::copy(iq.begin(), iq.end(), data->begin());
+  std::vector<rawMessage> messages;
+  Demodulator demodulator = Demodulator();
+  demodulator.Demodulate(data.get(), data->size(), 0, &messages);
+
+  ASSERT_EQ(messages.size(), 3);
+  EXPECT_EQ(messages[0].sample_index, 2000);
+  EXPECT_EQ(messages[1].sample_index, 3000);
+  EXPECT_EQ(messages[2].sample_index, 4000);
+  EXPECT_EQ(ADSBMessage(messages[1].bytes).icao, "4840D6");
+  ADSBMessage reply = ADSBMessage(messages[2].bytes);
+  EXPECT_EQ(reply.icao, "3C6585");
+  EXPECT_EQ(reply.altitude, 38000);
+  EXPECT_EQ(demodulator.stats.unconfirmed, 2);
+  EXPECT_TRUE(demodulator.icao_filter->contains(0x4840d6, 0.0));
+}
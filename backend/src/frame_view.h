@@ -0,0 +1,47 @@
+#ifndef ADSBOOST_FRAME_VIEW_H_
+#define ADSBOOST_FRAME_VIEW_H_
+
+#include <array>
+#include <cstdint>
+
+// Non-owning view of a Mode S frame. Bits are numbered 1 to 112 in the order
+// of transmission as in the specifications, e.g. the type code of an
+// extended squitter is bits<33, 37>().
+class FrameView {
+ public:
+  constexpr explicit FrameView(const unsigned char* bytes) : bytes(bytes) {}
+  constexpr FrameView(const std::array<unsigned char, 14>& frame)
+      : bytes(frame.data()) {}
+
+  template <int first, int last>
+  constexpr uint32_t bits() const {
+    static_assert(1 <= first && first <= last && last <= 112,
+                  "bits are numbered 1 to 112");
+    static_assert(last - first < 32, "at most 32 bits at once");
+    uint64_t value = 0;
+    for (int n = (first - 1) / 8; n <= (last - 1) / 8; n++) {
+      value = value << 8 | bytes[n];
+    }
+    return (value >> (7 - (last - 1) % 8)) &
+           ((uint64_t{1} << (last - first + 1)) - 1);
+  }
+
+  template <int n>
+  constexpr bool bit() const {
+    return bits<n, n>();
+  }
+
+  constexpr int downlink_format() const { return bits<1, 5>(); }
+  constexpr int capability() const { return bits<6, 8>(); }
+  // address announced in DF11/17/18. Other formats carry the AP field here,
+  // the address XORed with the CRC of the preceding bits.
+  constexpr uint32_t address() const { return bits<9, 32>(); }
+  constexpr int type_code() const { return bits<33, 37>(); }
+
+  constexpr const unsigned char* data() const { return bytes; }
+
+ private:
+  const unsigned char* bytes;
+};
+
+#endif  // ADSBOOST_FRAME_VIEW_H_
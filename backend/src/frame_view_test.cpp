@@ -0,0 +1,65 @@
+#include "frame_view.h"
+
+#include <gtest/gtest.h>
+
+#include "adsb_message.h"
+
+namespace {
+
+// DF17 airborne position, even frame
+constexpr std::array<unsigned char, 14> position_frame = {
+    0x8d, 0x40, 0x62, 0x1d, 0x58, 0xc3, 0x82,
+    0xd6, 0x90, 0xc8, 0xac, 0x28, 0x63, 0xa7};
+
+static_assert(FrameView(position_frame).downlink_format() == 17);
+static_assert(FrameView(position_frame).address() == 0x40621d);
+static_assert(FrameView(position_frame).type_code() == 11);
+
+}  // namespace
+
+class FrameViewTest : public ::testing::Test {
+ protected:
+  FrameViewTest() {}
+};
+
+TEST_F(FrameViewTest, CheckHeaderFields) {
+  FrameView frame(position_frame);
+  EXPECT_EQ(frame.downlink_format(), 17);
+  EXPECT_EQ(frame.capability(), 5);
+  EXPECT_EQ(frame.address(), 0x40621du);
+  EXPECT_EQ(frame.type_code(), 11);
+  EXPECT_EQ(frame.data(), position_frame.data());
+}
+
+TEST_F(FrameViewTest, CheckPositionFields) {
+  FrameView frame(position_frame);
+  EXPECT_FALSE(frame.bit<53>());
+  EXPECT_FALSE(frame.bit<54>());
+  EXPECT_TRUE(frame.bit<48>());
+  EXPECT_EQ((frame.bits<41, 47>() << 4 | frame.bits<49, 52>()), 1560u);
+  EXPECT_EQ((frame.bits<55, 71>()), 93000u);
+  EXPECT_EQ((frame.bits<72, 88>()), 51372u);
+}
+
+TEST_F(FrameViewTest, CheckFieldsSpanningBytes) {
+  std::array<unsigned char, 14> frame = {0xff, 0x00, 0xff, 0x00, 0xff,
+                                         0x00, 0xff, 0x00, 0xff, 0x00,
+                                         0xff, 0x00, 0xff, 0x00};
+  FrameView view(frame);
+  EXPECT_EQ((view.bits<1, 32>()), 0xff00ff00u);
+  EXPECT_EQ((view.bits<5, 12>()), 0xf0u);
+  EXPECT_EQ((view.bits<8, 17>()), 0x201u);
+  EXPECT_EQ((view.bits<105, 112>()), 0x00u);
+  EXPECT_EQ((view.bits<97, 104>()), 0xffu);
+}
+
+TEST_F(FrameViewTest, CheckMatchesMessageDecoding) {
+  ADSBMessage msg = ADSBMessage(position_frame);
+  FrameView frame(position_frame);
+  EXPECT_EQ(msg.downlink_format, frame.downlink_format());
+  EXPECT_EQ(msg.type_code, frame.type_code());
+  EXPECT_EQ(msg.icao, "40621D");
+  EXPECT_EQ(msg.altitude, 38000);
+  EXPECT_EQ(msg.lat_cpr, 93000 / 131072.0);
+  EXPECT_EQ(msg.lon_cpr, 51372 / 131072.0);
+}
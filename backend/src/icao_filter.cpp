@@ -0,0 +1,92 @@
+#include "icao_filter.h"
+
+#include <algorithm>
+
+IcaoFilter::IcaoFilter(double max_age)
+    : generation_seconds(max_age / (N_GENERATIONS - 2)),
+      bitmaps(new std::atomic<uint64_t>[N_GENERATIONS * N_WORDS]) {
+  for (auto &tag : tags) {
+    tag.store(-1);
+  }
+  for (size_t n = 0; n < N_GENERATIONS * N_WORDS; n++) {
+    bitmaps[n].store(0, std::memory_order_relaxed);
+  }
+}
+
+int64_t IcaoFilter::generation(double time) const {
+  return static_cast<int64_t>(std::max(time, 0.0) / generation_seconds);
+}
+
+std::atomic<uint64_t> *IcaoFilter::bitmap(int64_t generation) const {
+  return &bitmaps[(generation % N_GENERATIONS) * N_WORDS];
+}
+
+void IcaoFilter::advance(int64_t generation) {
+  int64_t last = current.load(std::memory_order_acquire);
+  while (last < generation) {
+    if (current.compare_exchange_weak(last, generation,
+                                      std::memory_order_acq_rel)) {
+      // recycle the bitmaps of the generations skipped over
+      for (int64_t n = std::max(last + 1, generation - N_GENERATIONS + 1);
+           n <= generation; n++) {
+        std::atomic<int64_t> &tag = tags[n % N_GENERATIONS];
+        tag.store(-1, std::memory_order_release);
+        std::atomic<uint64_t> *words = bitmap(n);
+        for (size_t word = 0; word < N_WORDS; word++) {
+          words[word].store(0, std::memory_order_relaxed);
+        }
+        tag.store(n, std::memory_order_release);
+      }
+      return;
+    }
+  }
+}
+
+void IcaoFilter::add(uint32_t icao, double time) {
+  icao &= 0xFFFFFF;
+  int64_t g = generation(time);
+  if (g > current.load(std::memory_order_acquire)) {
+    advance(g);
+  }
+  if (tags[g % N_GENERATIONS].load(std::memory_order_acquire) != g) {
+    // stale time, its generation has already been recycled
+    return;
+  }
+  bitmap(g)[icao / 64].fetch_or(uint64_t{1} << (icao % 64),
+                                std::memory_order_relaxed);
+}
+
+bool IcaoFilter::contains(uint32_t icao, double time) const {
+  icao &= 0xFFFFFF;
+  int64_t g = generation(time);
+  for (int64_t n = g; n >= 0 && n > g - (N_GENERATIONS - 1); n--) {
+    if (tags[n % N_GENERATIONS].load(std::memory_order_acquire) != n) {
+      continue;
+    }
+    uint64_t word = bitmap(n)[icao / 64].load(std::memory_order_relaxed);
+    if (word >> (icao % 64) & 1) {
+      return true;
+    }
+  }
+  return false;
+}
+
+size_t IcaoFilter::size() const {
+  int64_t g = current.load(std::memory_order_acquire);
+  std::array<const std::atomic<uint64_t> *, N_GENERATIONS> live = {};
+  int n_live = 0;
+  for (int64_t n = g; n >= 0 && n > g - (N_GENERATIONS - 1); n--) {
+    if (tags[n % N_GENERATIONS].load(std::memory_order_acquire) == n) {
+      live[n_live++] = bitmap(n);
+    }
+  }
+  size_t count = 0;
+  for (size_t word = 0; word < N_WORDS; word++) {
+    uint64_t bits = 0;
+    for (int n = 0; n < n_live; n++) {
+      bits |= live[n][word].load(std::memory_order_relaxed);
+    }
+    count += __builtin_popcountll(bits);
+  }
+  return count;
+}
@@ -0,0 +1,44 @@
+#ifndef ADSBOOST_ICAO_FILTER_H_
+#define ADSBOOST_ICAO_FILTER_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "config.h"
+
+// Addresses of aircraft confirmed by frames with a plain CRC (DF11/17/18).
+// The address recovered from the parity of other replies is only trusted if
+// it was confirmed within the last max_age seconds of stream time.
+//
+// One 16M-bit bitmap per generation of max_age / 2 seconds, an address is
+// kept for between max_age and 1.5 * max_age. Lookups and insertions are
+// lock-free; an address added while its generation is being recycled may be
+// lost, which only delays the confirmation until its next sighting. Stream
+// time is expected to be (roughly) monotonic.
+class IcaoFilter {
+ public:
+  explicit IcaoFilter(double max_age = ICAO_FILTER_SECONDS);
+
+  void add(uint32_t icao, double time);
+  bool contains(uint32_t icao, double time) const;
+  // number of distinct addresses in the live generations, for diagnostics
+  size_t size() const;
+
+ private:
+  static constexpr int N_GENERATIONS = 4;
+  static constexpr size_t N_WORDS = (size_t{1} << 24) / 64;
+
+  double generation_seconds;
+  std::atomic<int64_t> current{-1};
+  // generation held by each bitmap, -1 while it is empty or being cleared
+  std::array<std::atomic<int64_t>, N_GENERATIONS> tags;
+  std::unique_ptr<std::atomic<uint64_t>[]> bitmaps;
+
+  int64_t generation(double time) const;
+  void advance(int64_t generation);
+  std::atomic<uint64_t> *bitmap(int64_t generation) const;
+};
+
+#endif  // ADSBOOST_ICAO_FILTER_H_
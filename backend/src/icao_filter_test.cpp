@@ -0,0 +1,45 @@
+#include "icao_filter.h"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+class IcaoFilterTest : public ::testing::Test {
+ protected:
+  IcaoFilterTest() {}
+};
+
+TEST_F(IcaoFilterTest, CheckIcaoFilterAgeing) {
+  IcaoFilter filter = IcaoFilter(60.0);
+  filter.add(0x3c6585, 10.0);
+  EXPECT_TRUE(filter.contains(0x3c6585, 40.0));
+  EXPECT_FALSE(filter.contains(0x3c6586, 10.0));
+  // kept for at least max_age
+  EXPECT_TRUE(filter.contains(0x3c6585, 69.0));
+  // refreshed by a later sighting
+  filter.add(0x3c6585, 70.0);
+  EXPECT_TRUE(filter.contains(0x3c6585, 129.0));
+  // and gone after at most 1.5 * max_age
+  EXPECT_FALSE(filter.contains(0x3c6585, 161.0));
+  filter.add(0x4840d6, 200.0);
+  EXPECT_FALSE(filter.contains(0x3c6585, 200.0));
+  EXPECT_EQ(filter.size(), 1);
+}
+
+TEST_F(IcaoFilterTest, CheckIcaoFilterConcurrentAccess) {
+  IcaoFilter filter = IcaoFilter(60.0);
+  std::vector<std::thread> threads;
+  for (uint32_t n_thread = 0; n_thread < 4; n_thread++) {
+    threads.emplace_back([&filter, n_thread]() {
+      for (uint32_t icao = n_thread; icao < 4000; icao += 4) {
+        filter.add(icao, 1.0);
+        EXPECT_TRUE(filter.contains(icao, 1.0));
+      }
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(filter.size(), 4000);
+}
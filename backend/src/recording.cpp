@@ -0,0 +1,107 @@
+#include "recording.h"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+void append_demod_output_file(
+    const std::string &filename,
+    const std::vector<ADSBMessage> &decoded_messages) {
+  // Open file for output in append mode; create it if it does not exist
+  std::ofstream file(filename,
+                     std::ios::out | std::ios::binary | std::ios::app);
+
+  if (!file) {
+    std::cerr << "Error opening file for writing.\n";
+    return;
+  }
+  file.seekp(0, std::ios::end);
+  if (file.tellp() == 0) {
+    file.write(DEMOD_FILE_MAGIC, std::strlen(DEMOD_FILE_MAGIC));
+  }
+
+  for (const auto &msg : decoded_messages) {
+    file.write(reinterpret_cast<const char *>(msg.message.data()),
+               msg.message.size());
+
+    // Serialize and write the timestamps
+    auto duration_since_epoch = msg.timestamp.time_since_epoch();
+
+    auto time = std::chrono::duration_cast<std::chrono::milliseconds>(
+                    duration_since_epoch)
+                    .count();
+    file.write(reinterpret_cast<const char *>(&time), sizeof(time));
+    file.write(reinterpret_cast<const char *>(&msg.timestamp_12mhz),
+               sizeof(msg.timestamp_12mhz));
+
+    if (!file) {
+      std::cerr << "Error writing to file.\n";
+    }
+  }
+  file.close();
+}
+
+void read_demod_messages(std::string filename,
+                         std::vector<ADSBMessage> *messages) {
+  std::ifstream file(filename, std::ios::in | std::ios::binary);
+  if (!file) {
+    std::cerr << "Error opening file for reading.\n";
+    return;
+  }
+
+  char magic[sizeof(DEMOD_FILE_MAGIC) - 1];
+  file.read(magic, sizeof(magic));
+  bool has_12mhz_timestamp =
+      file && std::memcmp(magic, DEMOD_FILE_MAGIC, sizeof(magic)) == 0;
+  if (!has_12mhz_timestamp) {
+    // file from an older version, records start right away
+    file.clear();
+    file.seekg(0);
+  }
+
+  while (file) {
+    std::array<unsigned char, 14> message;
+    file.read(reinterpret_cast<char *>(message.data()), message.size());
+
+    long long time_count;
+    file.read(reinterpret_cast<char *>(&time_count), sizeof(time_count));
+    uint64_t timestamp_12mhz = 0;
+    if (has_12mhz_timestamp) {
+      file.read(reinterpret_cast<char *>(&timestamp_12mhz),
+                sizeof(timestamp_12mhz));
+    }
+    if (!file) break;
+    std::chrono::system_clock::time_point timestamp =
+        std::chrono::system_clock::time_point(
+            std::chrono::milliseconds(time_count));
+    ADSBMessage msg = ADSBMessage(message, timestamp);
+    msg.timestamp_12mhz = timestamp_12mhz;
+    messages->push_back(msg);
+  }
+  return;
+}
+
+void append_raw_output_file(
+    const std::string &filename,
+    const std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP> *data,
+    size_t len) {
+  if (len <= BUFFER_OVERLAP) return;
+  // Open file for output in append mode; create it if it does not exist
+  std::ofstream file(filename,
+                     std::ios::out | std::ios::binary | std::ios::app);
+
+  if (!file) {
+    std::cerr << "Error opening file for writing.\n";
+    return;
+  }
+
+  // Write the new part of the buffer to the file
+  file.write(reinterpret_cast<const char *>(data->data() + BUFFER_OVERLAP),
+             len - BUFFER_OVERLAP);
+
+  if (!file) {
+    std::cerr << "Error writing to file.\n";
+  }
+
+  file.close();
+}
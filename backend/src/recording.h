@@ -0,0 +1,29 @@
+#ifndef ADSBOOST_RECORDING_H_
+#define ADSBOOST_RECORDING_H_
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "adsb_message.h"
+#include "config.h"
+
+// Demod files start with this magic, followed by records of the 14 message
+// bytes, the timestamp in ms since epoch (int64) and the 12 MHz timestamp
+// (uint64). Files without the magic hold records without the 12 MHz
+// timestamp.
+#define DEMOD_FILE_MAGIC "ADSBDMD2"
+
+void append_demod_output_file(const std::string &filename,
+                              const std::vector<ADSBMessage> &decoded_messages);
+void read_demod_messages(std::string filename,
+                         std::vector<ADSBMessage> *messages);
+
+// Appends the len - BUFFER_OVERLAP new bytes of the buffer, so that the file
+// is a continuous stream of samples.
+void append_raw_output_file(
+    const std::string &filename,
+    const std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP> *data,
+    size_t len);
+
+#endif  // ADSBOOST_RECORDING_H_
@@ -0,0 +1,71 @@
+#include "recording.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <memory>
+
+class RecordingTest : public ::testing::Test {
+ protected:
+  RecordingTest() {}
+  std::array<unsigned char, 14> message_1 = {0x8d, 0x3c, 0x65, 0x85, 0x23,
+                                             0x10, 0xc2, 0x34, 0x04, 0x88,
+                                             0x20, 0x5a, 0x8f, 0xaf};
+  std::array<unsigned char, 14> message_2 = {0x8d, 0x4d, 0x24, 0x14, 0x58,
+                                             0xc3, 0x93, 0xbc, 0x05, 0xfd,
+                                             0x7f, 0xf0, 0x81, 0x1e};
+};
+
+TEST_F(RecordingTest, DemodFileRoundTrip) {
+  std::string filename = testing::TempDir() + "recording_test_demod.bin";
+  std::remove(filename.c_str());
+  auto t0 = std::chrono::system_clock::time_point(std::chrono::hours(1000));
+  std::vector<ADSBMessage> messages = {
+      ADSBMessage(message_1, t0, 1234),
+      ADSBMessage(message_2, t0 + std::chrono::milliseconds(10), 121234)};
+  // appending twice writes the magic only once
+  append_demod_output_file(filename, {messages[0]});
+  append_demod_output_file(filename, {messages[1]});
+
+  std::vector<ADSBMessage> read_messages;
+  read_demod_messages(filename, &read_messages);
+  ASSERT_EQ(read_messages.size(), 2);
+  for (size_t n = 0; n < 2; n++) {
+    EXPECT_EQ(read_messages[n].message, messages[n].message);
+    EXPECT_EQ(read_messages[n].timestamp, messages[n].timestamp);
+    EXPECT_EQ(read_messages[n].timestamp_12mhz, messages[n].timestamp_12mhz);
+  }
+}
+
+TEST_F(RecordingTest, ReadLegacyDemodFile) {
+  std::string filename = testing::TempDir() + "recording_test_legacy.bin";
+  std::ofstream file(filename, std::ios::binary);
+  long long time = 3600000;
+  file.write(reinterpret_cast<const char *>(message_1.data()), 14);
+  file.write(reinterpret_cast<const char *>(&time), sizeof(time));
+  file.close();
+
+  std::vector<ADSBMessage> read_messages;
+  read_demod_messages(filename, &read_messages);
+  ASSERT_EQ(read_messages.size(), 1);
+  EXPECT_EQ(read_messages[0].icao, "3C6585");
+  EXPECT_EQ(read_messages[0].timestamp.time_since_epoch(),
+            std::chrono::milliseconds(time));
+  EXPECT_EQ(read_messages[0].timestamp_12mhz, 0);
+}
+
+TEST_F(RecordingTest, RawFileSkipsOverlap) {
+  std::string filename = testing::TempDir() + "recording_test_raw.bin";
+  std::remove(filename.c_str());
+  auto data =
+      std::make_unique<std::array<unsigned char, BUFFER_LEN + BUFFER_OVERLAP>>();
+  data->fill(1);
+  std::fill(data->begin(), data->begin() + BUFFER_OVERLAP, 0);
+  append_raw_output_file(filename, data.get(), BUFFER_OVERLAP + 100);
+
+  std::ifstream file(filename, std::ios::binary | std::ios::ate);
+  EXPECT_EQ(file.tellg(), 100);
+  file.seekg(0);
+  EXPECT_EQ(file.get(), 1);
+}
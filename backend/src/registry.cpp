@@ -0,0 +1,226 @@
+#include "registry.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+struct RegistryHeader {
+  char magic[8];
+  uint32_t record_size;
+  uint32_t n_records;
+};
+
+static_assert(sizeof(RegistryHeader) == 16);
+
+// fields end up in JSON strings unescaped
+template <size_t N>
+void copy_field(const std::string& value, char (&field)[N]) {
+  std::memset(field, 0, N);
+  // long values are cut before a UTF-8 code point that does not fit
+  size_t len = std::min(value.size(), N);
+  while (len > 0 && len < value.size() &&
+         (static_cast<unsigned char>(value[len]) & 0xC0) == 0x80) {
+    len--;
+  }
+  for (size_t n = 0; n < len; n++) {
+    char c = value[n];
+    if (c == '"') {
+      c = '\'';
+    } else if (c == '\\' || static_cast<unsigned char>(c) < 0x20) {
+      c = ' ';
+    }
+    field[n] = c;
+  }
+}
+
+int find_column(const std::vector<std::string>& header,
+                const std::string& name) {
+  for (size_t n = 0; n < header.size(); n++) {
+    std::string column = header[n];
+    std::transform(column.begin(), column.end(), column.begin(), ::tolower);
+    if (column == name) return n;
+  }
+  return -1;
+}
+
+}  // namespace
+
+AircraftRegistry::~AircraftRegistry() {
+  if (mapping != nullptr) {
+    munmap(mapping, mapping_size);
+  }
+}
+
+bool AircraftRegistry::open(const std::string& filename) {
+  int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd < 0) {
+    std::cerr << "Error opening registry file " << filename << ".\n";
+    return false;
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 ||
+      static_cast<size_t>(file_stat.st_size) < sizeof(RegistryHeader)) {
+    std::cerr << "Invalid registry file " << filename << ".\n";
+    close(fd);
+    return false;
+  }
+  size_t size = file_stat.st_size;
+  void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (data == MAP_FAILED) {
+    std::cerr << "Error mapping registry file " << filename << ".\n";
+    return false;
+  }
+
+  const RegistryHeader* header = static_cast<const RegistryHeader*>(data);
+  if (std::memcmp(header->magic, REGISTRY_FILE_MAGIC, sizeof(header->magic)) !=
+          0 ||
+      header->record_size != sizeof(RegistryRecord) ||
+      size < sizeof(RegistryHeader) +
+                 size_t{header->n_records} * sizeof(RegistryRecord)) {
+    std::cerr << "Invalid registry file " << filename << ".\n";
+    munmap(data, size);
+    return false;
+  }
+  // lookups jump around the file, read ahead would only waste memory
+  madvise(data, size, MADV_RANDOM);
+
+  if (mapping != nullptr) {
+    munmap(mapping, mapping_size);
+  }
+  mapping = data;
+  mapping_size = size;
+  n_records = header->n_records;
+  records = reinterpret_cast<const RegistryRecord*>(
+      static_cast<const char*>(data) + sizeof(RegistryHeader));
+  return true;
+}
+
+bool AircraftRegistry::is_open() const { return mapping != nullptr; }
+
+size_t AircraftRegistry::size() const { return n_records; }
+
+const RegistryRecord* AircraftRegistry::lookup(uint32_t address) const {
+  const RegistryRecord* end = records + n_records;
+  const RegistryRecord* record = std::lower_bound(
+      records, end, address, [](const RegistryRecord& record, uint32_t key) {
+        return record.address < key;
+      });
+  if (record == end || record->address != address) {
+    return nullptr;
+  }
+  return record;
+}
+
+std::vector<std::string> parse_csv_line(const std::string& line) {
+  std::vector<std::string> fields;
+  std::string field;
+  bool quoted = false;
+  for (size_t n = 0; n < line.size(); n++) {
+    char c = line[n];
+    if (quoted) {
+      if (c == '"' && n + 1 < line.size() && line[n + 1] == '"') {
+        field += '"';
+        n++;
+      } else if (c == '"') {
+        quoted = false;
+      } else {
+        field += c;
+      }
+    } else if (c == '"') {
+      quoted = true;
+    } else if (c == ',') {
+      fields.push_back(field);
+      field.clear();
+    } else if (c != '\r') {
+      field += c;
+    }
+  }
+  fields.push_back(field);
+  return fields;
+}
+
+long build_registry(std::istream& csv, const std::string& filename) {
+  std::string line;
+  if (!std::getline(csv, line)) {
+    std::cerr << "Empty registry CSV.\n";
+    return -1;
+  }
+  std::vector<std::string> header = parse_csv_line(line);
+  int address_column = find_column(header, "icao24");
+  int registration_column = find_column(header, "registration");
+  int type_column = find_column(header, "typecode");
+  int operator_column = find_column(header, "operator");
+  if (address_column < 0) {
+    std::cerr << "Registry CSV has no icao24 column.\n";
+    return -1;
+  }
+
+  std::vector<RegistryRecord> records;
+  auto field = [](const std::vector<std::string>& fields, int column) {
+    if (column < 0 || column >= static_cast<int>(fields.size())) return "";
+    return fields[column].c_str();
+  };
+  while (std::getline(csv, line)) {
+    std::vector<std::string> fields = parse_csv_line(line);
+    std::string address = field(fields, address_column);
+    char* end = nullptr;
+    unsigned long value = std::strtoul(address.c_str(), &end, 16);
+    if (address.empty() || *end != '\0' || value > 0xffffff) {
+      continue;
+    }
+    RegistryRecord record{};
+    record.address = value;
+    copy_field(field(fields, registration_column), record.registration);
+    copy_field(field(fields, type_column), record.type_designator);
+    copy_field(field(fields, operator_column), record.operator_name);
+    records.push_back(record);
+  }
+  std::stable_sort(records.begin(), records.end(),
+                   [](const RegistryRecord& a, const RegistryRecord& b) {
+                     return a.address < b.address;
+                   });
+  records.erase(std::unique(records.begin(), records.end(),
+                            [](const RegistryRecord& a,
+                               const RegistryRecord& b) {
+                              return a.address == b.address;
+                            }),
+                records.end());
+
+  std::string temp_filename = filename + ".tmp";
+  std::ofstream file(temp_filename,
+                     std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file) {
+    std::cerr << "Error opening registry file for writing.\n";
+    return -1;
+  }
+  RegistryHeader file_header{};
+  std::memcpy(file_header.magic, REGISTRY_FILE_MAGIC,
+              sizeof(file_header.magic));
+  file_header.record_size = sizeof(RegistryRecord);
+  file_header.n_records = records.size();
+  file.write(reinterpret_cast<const char*>(&file_header), sizeof(file_header));
+  file.write(reinterpret_cast<const char*>(records.data()),
+             records.size() * sizeof(RegistryRecord));
+  file.close();
+  if (!file) {
+    std::cerr << "Error writing registry file.\n";
+    std::remove(temp_filename.c_str());
+    return -1;
+  }
+  // a running ads-boost keeps the old file mapped
+  if (std::rename(temp_filename.c_str(), filename.c_str()) != 0) {
+    std::cerr << "Error replacing registry file.\n";
+    return -1;
+  }
+  return records.size();
+}
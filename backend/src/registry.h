@@ -0,0 +1,62 @@
+#ifndef ADSBOOST_REGISTRY_H_
+#define ADSBOOST_REGISTRY_H_
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+// Registry files start with this magic, the size of a RegistryRecord and the
+// number of records (uint32 each), followed by the records sorted by address.
+// Text fields are zero padded and not terminated when they fill the field,
+// they hold no double quotes, backslashes or control characters.
+#define REGISTRY_FILE_MAGIC "ADSBREG1"
+
+struct RegistryRecord {
+  uint32_t address;
+  char registration[12];
+  char type_designator[8];
+  char operator_name[40];
+};
+
+static_assert(sizeof(RegistryRecord) == 64);
+
+// Aircraft registry memory-mapped from a file built by build-registry. Opening
+// only maps the file, pages are read on demand by the binary search of a
+// lookup, so only the pages touched count towards the resident memory.
+class AircraftRegistry {
+ public:
+  AircraftRegistry() = default;
+  ~AircraftRegistry();
+  AircraftRegistry(const AircraftRegistry&) = delete;
+  AircraftRegistry& operator=(const AircraftRegistry&) = delete;
+
+  bool open(const std::string& filename);
+  bool is_open() const;
+  size_t size() const;
+  // record of the address, null if it is not registered
+  const RegistryRecord* lookup(uint32_t address) const;
+
+ private:
+  void* mapping = nullptr;
+  size_t mapping_size = 0;
+  const RegistryRecord* records = nullptr;
+  size_t n_records = 0;
+};
+
+// Splits a CSV line, fields may be quoted with "" as escaped quote.
+std::vector<std::string> parse_csv_line(const std::string& line);
+// Builds a registry file from a CSV with a header naming the columns icao24,
+// registration, typecode and operator (as in the OpenSky aircraft database).
+// Rows with an invalid address are skipped, of duplicates the first is kept.
+// Returns the number of records written, -1 on error.
+long build_registry(std::istream& csv, const std::string& filename);
+// Text of a zero padded record field.
+template <size_t N>
+std::string registry_field(const char (&field)[N]) {
+  size_t length = 0;
+  while (length < N && field[length] != '\0') length++;
+  return std::string(field, length);
+}
+
+#endif  // ADSBOOST_REGISTRY_H_
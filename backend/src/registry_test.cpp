@@ -0,0 +1,125 @@
+#include "registry.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include "contact.h"
+
+class RegistryTest : public ::testing::Test {
+ protected:
+  RegistryTest() {}
+
+  std::string csv =
+      "\"icao24\",\"registration\",\"model\",\"typecode\",\"operator\"\n"
+      "\"3c6585\",\"D-AIQA\",\"A320\",\"A320\",\"Lufthansa\"\n"
+      "\"40621d\",\"G-EZUB\",\"A319\",\"A319\",\"easyJet\"\n"
+      "\"zzzzzz\",\"X-XXXX\",\"\",\"\",\"\"\n"
+      "\"3c6585\",\"D-AIQB\",\"A320\",\"A320\",\"duplicate\"\n"
+      "\"4840d6\",\"PH-BXA\",\"737-800\",\"B738\",\"KLM \"\"Royal\"\" "
+      "Dutch Airlines, a very long operator name\"\n";
+  std::array<unsigned char, 14> identification = {
+      0x8d, 0x3c, 0x65, 0x85, 0x23, 0x10, 0xc2,
+      0x34, 0x04, 0x88, 0x20, 0x5a, 0x8f, 0xaf};
+
+  std::string build(const std::string& name) {
+    std::string filename = testing::TempDir() + name;
+    std::remove(filename.c_str());
+    std::istringstream input(csv);
+    EXPECT_EQ(build_registry(input, filename), 3);
+    return filename;
+  }
+};
+
+TEST_F(RegistryTest, CheckParseCsvLine) {
+  std::vector<std::string> fields =
+      parse_csv_line("a,\"b,c\",,\"d \"\"e\"\"\"\r");
+  ASSERT_EQ(fields.size(), 4);
+  EXPECT_EQ(fields[0], "a");
+  EXPECT_EQ(fields[1], "b,c");
+  EXPECT_EQ(fields[2], "");
+  EXPECT_EQ(fields[3], "d \"e\"");
+}
+
+TEST_F(RegistryTest, CheckLookup) {
+  std::string filename = build("registry_test_lookup.bin");
+  AircraftRegistry registry;
+  EXPECT_FALSE(registry.is_open());
+  ASSERT_TRUE(registry.open(filename));
+  EXPECT_EQ(registry.size(), 3);
+
+  const RegistryRecord* record = registry.lookup(0x3c6585);
+  ASSERT_NE(record, nullptr);
+  EXPECT_EQ(registry_field(record->registration), "D-AIQA");
+  EXPECT_EQ(registry_field(record->type_designator), "A320");
+  EXPECT_EQ(registry_field(record->operator_name), "Lufthansa");
+
+  record = registry.lookup(0x4840d6);
+  ASSERT_NE(record, nullptr);
+  EXPECT_EQ(registry_field(record->type_designator), "B738");
+  // quotes are replaced and long names cut to the field size
+  EXPECT_EQ(registry_field(record->operator_name),
+            "KLM 'Royal' Dutch Airlines, a very long ");
+
+  EXPECT_NE(registry.lookup(0x40621d), nullptr);
+  EXPECT_EQ(registry.lookup(0x000000), nullptr);
+  EXPECT_EQ(registry.lookup(0x3c6586), nullptr);
+  EXPECT_EQ(registry.lookup(0xffffff), nullptr);
+  std::remove(filename.c_str());
+}
+
+TEST_F(RegistryTest, CheckUtf8Truncation) {
+  std::string filename = testing::TempDir() + "registry_test_utf8.bin";
+  // the 40 byte field ends within the two bytes of the \u00f1
+  std::istringstream input(
+      "icao24,registration,typecode,operator\n"
+      "34520c,EC-MLD,A320,Aerol\u00edneas Ejecutivas del Noreste "
+      "Espa\u00f1ol\n");
+  ASSERT_EQ(build_registry(input, filename), 1);
+  AircraftRegistry registry;
+  ASSERT_TRUE(registry.open(filename));
+  const RegistryRecord* record = registry.lookup(0x34520c);
+  ASSERT_NE(record, nullptr);
+  EXPECT_EQ(registry_field(record->operator_name),
+            "Aerol\u00edneas Ejecutivas del Noreste Espa");
+  std::remove(filename.c_str());
+}
+
+TEST_F(RegistryTest, CheckInvalidFile) {
+  AircraftRegistry registry;
+  std::string filename = testing::TempDir() + "registry_test_invalid.bin";
+  std::remove(filename.c_str());
+  EXPECT_FALSE(registry.open(filename));
+
+  std::istringstream input("registration,typecode\nD-AIQA,A320\n");
+  EXPECT_EQ(build_registry(input, filename), -1);
+  std::ofstream file(filename, std::ios::binary);
+  file << "ADSBREG1 but not a registry";
+  file.close();
+  EXPECT_FALSE(registry.open(filename));
+  EXPECT_FALSE(registry.is_open());
+  std::remove(filename.c_str());
+}
+
+TEST_F(RegistryTest, CheckContactEnrichment) {
+  std::string filename = build("registry_test_contact.bin");
+  AircraftRegistry registry;
+  ASSERT_TRUE(registry.open(filename));
+
+  ContactList contacts(60);
+  contacts.update(ADSBMessage(identification));
+  std::string json = contacts.contacts.front().to_json();
+  EXPECT_EQ(json.find("registration"), std::string::npos);
+
+  ContactList enriched(60);
+  enriched.registry = &registry;
+  enriched.update(ADSBMessage(identification));
+  json = enriched.contacts.front().to_json();
+  EXPECT_NE(json.find("\"squawk\": \"\",\"registration\": "
+                      "\"D-AIQA\",\"type_designator\": "
+                      "\"A320\",\"operator\": \"Lufthansa\","),
+            std::string::npos);
+  std::remove(filename.c_str());
+}
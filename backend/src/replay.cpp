@@ -0,0 +1,84 @@
+#include "replay.h"
+
+#include <iomanip>
+#include <thread>
+
+double parse_replay_speed(std::string speed) {
+  if (speed == "max") return 0;
+  if (!speed.empty() && (speed.back() == 'x' || speed.back() == 'X')) {
+    speed.pop_back();
+  }
+  try {
+    size_t n_parsed;
+    double value = std::stod(speed, &n_parsed);
+    if (n_parsed != speed.size() || value < 0) return -1;
+    return value;
+  } catch (const std::exception&) {
+    return -1;
+  }
+}
+
+ReplayEngine::ReplayEngine(VirtualClock* clock, double speed) {
+  this->clock = clock;
+  this->speed = speed;
+}
+
+void ReplayEngine::advance_to(std::chrono::system_clock::time_point timestamp) {
+  if (!started) {
+    started = true;
+    first_timestamp = timestamp;
+    last_timestamp = timestamp;
+    wall_start = std::chrono::steady_clock::now();
+  }
+  if (timestamp > last_timestamp) last_timestamp = timestamp;
+  if (speed > 0 && timestamp > first_timestamp) {
+    auto replay_offset = std::chrono::duration_cast<std::chrono::microseconds>(
+        (timestamp - first_timestamp) / speed);
+    std::this_thread::sleep_until(wall_start + replay_offset);
+  }
+  clock->advance(timestamp);
+}
+
+void ReplayEngine::count(size_t n_messages, size_t n_contact_updates) {
+  this->n_messages += n_messages;
+  this->n_contact_updates += n_contact_updates;
+}
+
+void ReplayEngine::count_contact(const std::string& icao) {
+  contacts_seen.insert(icao);
+}
+
+size_t ReplayEngine::n_contacts() { return contacts_seen.size(); }
+
+double ReplayEngine::replayed_seconds() {
+  if (!started) return 0;
+  return std::chrono::duration<double>(last_timestamp - first_timestamp)
+      .count();
+}
+
+double ReplayEngine::wall_seconds() {
+  if (!started) return 0;
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       wall_start)
+      .count();
+}
+
+void ReplayEngine::print_report(std::ostream& out) {
+  double wall = wall_seconds();
+  double replayed = replayed_seconds();
+  double rate_divisor = (wall > 0) ? wall : 1;
+  out << std::fixed << std::setprecision(2);
+  out << "Replay report" << std::endl;
+  out << "  speed:           "
+      << ((speed > 0) ? std::to_string(speed) + "x" : "max") << std::endl;
+  out << "  recorded time:   " << replayed << " s" << std::endl;
+  out << "  wall time:       " << wall << " s";
+  if (wall > 0) out << " (" << replayed / wall << "x real time)";
+  out << std::endl;
+  out << "  messages:        " << n_messages << " ("
+      << n_messages / rate_divisor << " msg/s)" << std::endl;
+  out << "  contact updates: " << n_contact_updates << " ("
+      << n_contact_updates / rate_divisor << " updates/s)" << std::endl;
+  out << "  contacts:        " << n_contacts() << " ("
+      << n_contacts() / rate_divisor << " contacts/s)" << std::endl;
+}
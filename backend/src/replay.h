@@ -0,0 +1,43 @@
+#ifndef ADSBOOST_REPLAY_H_
+#define ADSBOOST_REPLAY_H_
+
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <unordered_set>
+
+#include "clock.h"
+
+// Parses a replay speed such as "1x", "10x" or "2.5". "max" (or 0) means
+// replay as fast as possible. Returns -1 if the value cannot be parsed.
+double parse_replay_speed(std::string speed);
+
+// Paces replayed messages relative to wall time and drives a VirtualClock
+// with their timestamps.
+class ReplayEngine {
+ public:
+  double speed = 1.0;
+  size_t n_messages = 0;
+  size_t n_contact_updates = 0;
+
+  ReplayEngine(VirtualClock* clock, double speed);
+  void advance_to(std::chrono::system_clock::time_point timestamp);
+  void count(size_t n_messages, size_t n_contact_updates);
+  // distinct contacts of the replay, updates are counted by count()
+  void count_contact(const std::string& icao);
+  size_t n_contacts();
+  double replayed_seconds();
+  double wall_seconds();
+  void print_report(std::ostream& out);
+
+ private:
+  VirtualClock* clock;
+  bool started = false;
+  std::chrono::system_clock::time_point first_timestamp;
+  std::chrono::system_clock::time_point last_timestamp;
+  std::chrono::steady_clock::time_point wall_start;
+  std::unordered_set<std::string> contacts_seen;
+};
+
+#endif  // ADSBOOST_REPLAY_H_
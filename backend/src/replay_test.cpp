@@ -0,0 +1,106 @@
+#include "replay.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <sstream>
+#include <string>
+
+#include "contact.h"
+
+class ReplayTest : public ::testing::Test {
+ protected:
+  ReplayTest() {}
+};
+
+TEST_F(ReplayTest, ParseReplaySpeed) {
+  EXPECT_EQ(parse_replay_speed("1x"), 1.0);
+  EXPECT_EQ(parse_replay_speed("10x"), 10.0);
+  EXPECT_EQ(parse_replay_speed("2.5"), 2.5);
+  EXPECT_EQ(parse_replay_speed("max"), 0.0);
+  EXPECT_EQ(parse_replay_speed("fast"), -1.0);
+  EXPECT_EQ(parse_replay_speed("-2x"), -1.0);
+}
+
+TEST_F(ReplayTest, VirtualClockOnlyMovesForward) {
+  VirtualClock clock;
+  auto t0 = std::chrono::system_clock::time_point(std::chrono::seconds(1000));
+  clock.advance(t0);
+  EXPECT_EQ(clock.now(), t0);
+  clock.advance(t0 - std::chrono::seconds(5));
+  EXPECT_EQ(clock.now(), t0);
+  clock.advance(t0 + std::chrono::seconds(5));
+  EXPECT_EQ(clock.now(), t0 + std::chrono::seconds(5));
+}
+
+TEST_F(ReplayTest, ContactsAgeWithVirtualClock) {
+  std::array<unsigned char, 14> message = {0x8d, 0x3c, 0x65, 0x85, 0x23,
+                                           0x10, 0xc2, 0x34, 0x04, 0x88,
+                                           0x20, 0x5a, 0x8f, 0xaf};
+  // recorded a long time ago, would time out immediately on the system clock
+  auto recorded = std::chrono::system_clock::time_point(std::chrono::hours(1));
+  VirtualClock clock;
+  ContactList contacts = ContactList(10);
+  contacts.clock = &clock;
+  clock.advance(recorded);
+  contacts.update(ADSBMessage(message, recorded));
+  EXPECT_EQ(contacts.get_contacts()->size(), 1);
+  EXPECT_EQ(contacts.get_contact("3C6585")->last_seen(), 0);
+
+  clock.advance(recorded + std::chrono::seconds(11));
+  EXPECT_EQ(contacts.get_contacts()->size(), 0);
+}
+
+TEST_F(ReplayTest, MaxSpeedDoesNotSleep) {
+  VirtualClock clock;
+  ReplayEngine engine(&clock, 0);
+  auto t0 = std::chrono::system_clock::time_point(std::chrono::hours(1));
+  engine.advance_to(t0);
+  engine.advance_to(t0 + std::chrono::hours(1));
+  engine.count(10, 5);
+  EXPECT_EQ(clock.now(), t0 + std::chrono::hours(1));
+  EXPECT_NEAR(engine.replayed_seconds(), 3600, 1e-6);
+  EXPECT_LT(engine.wall_seconds(), 1.0);
+  EXPECT_EQ(engine.n_messages, 10);
+  EXPECT_EQ(engine.n_contact_updates, 5);
+}
+
+TEST_F(ReplayTest, CountsDistinctContacts) {
+  VirtualClock clock;
+  ReplayEngine engine(&clock, 0);
+  engine.count(3, 3);
+  for (std::string icao : {"3C6585", "4840D6", "3C6585"}) {
+    engine.count_contact(icao);
+  }
+  EXPECT_EQ(engine.n_contact_updates, 3);
+  EXPECT_EQ(engine.n_contacts(), 2);
+  std::stringstream report;
+  engine.print_report(report);
+  EXPECT_NE(report.str().find("contact updates: 3 ("), std::string::npos);
+  EXPECT_NE(report.str().find("contacts:        2 ("), std::string::npos);
+}
+
+TEST_F(ReplayTest, PacedReplay) {
+  VirtualClock clock;
+  ReplayEngine engine(&clock, 10);
+  auto t0 = std::chrono::system_clock::time_point(std::chrono::hours(1));
+  engine.advance_to(t0);
+  engine.advance_to(t0 + std::chrono::milliseconds(500));
+  EXPECT_GE(engine.wall_seconds(), 0.05);
+}
+
+TEST_F(ReplayTest, StreamClockConversion) {
+  auto start = std::chrono::system_clock::time_point(std::chrono::hours(1));
+  StreamClock stream_clock = {start, 2000000};
+  EXPECT_EQ(stream_clock.to_ticks(0), 0);
+  EXPECT_EQ(stream_clock.to_ticks(1), 6);
+  EXPECT_EQ(stream_clock.to_ticks(2000000), 12000000);
+  // one day of samples does not overflow
+  uint64_t one_day = 2000000ull * 86400;
+  EXPECT_EQ(stream_clock.to_ticks(one_day + 3), 12000000ull * 86400 + 18);
+  EXPECT_EQ(stream_clock.to_time(1) - start, std::chrono::nanoseconds(500));
+  EXPECT_EQ(stream_clock.to_time(one_day) - start, std::chrono::hours(24));
+
+  StreamClock stream_clock_24 = {start, 2400000};
+  EXPECT_EQ(stream_clock_24.to_ticks(1), 5);
+}
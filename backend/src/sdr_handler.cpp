@@ -35,7 +35,10 @@ rtlsdr_dev_t *init_rtlsdr(uint32_t center_frequency, uint32_t sample_rate)
     rtlsdr_set_tuner_gain(dev, max_gain);
     rtlsdr_set_freq_correction(dev, 0);
     rtlsdr_set_center_freq(dev, center_frequency);
-    rtlsdr_set_sample_rate(dev, sample_rate);
+    if (rtlsdr_set_sample_rate(dev, sample_rate) != 0)
+    {
+      printf("Failed to set sample rate: %u\n", sample_rate);
+    }
     rtlsdr_reset_buffer(dev);
     printf("Tuner gain at: %i\n", rtlsdr_get_tuner_gain(dev));
   }
@@ -64,16 +67,25 @@ void SDRHandler::read_data_async(SharedBuffer *buffer)
 void SDRHandler::read_callback(unsigned char *buf, uint32_t len, void *ctx)
 {
   SharedBuffer *buffer = static_cast<SharedBuffer *>(ctx);
+  auto now = std::chrono::system_clock::now();
 
   {
     std::unique_lock<std::mutex> lock{buffer->mutex};
+    if (buffer->n_samples == 0) {
+      // the first sample was taken one buffer length before the callback
+      buffer->stream_start =
+          now - std::chrono::microseconds(uint64_t(len / 2) * 1000000 /
+                                          buffer->sample_rate);
+    }
 
     std::copy(buffer->data.end() - BUFFER_OVERLAP, buffer->data.end(),
               buffer->data.begin());
     std::copy(buf, buf + len, buffer->data.begin() + BUFFER_OVERLAP);
+    buffer->first_sample = buffer->n_samples;
+    buffer->n_samples += len / 2;
+    buffer->has_data = true;
+    buffer->len = len + BUFFER_OVERLAP;
   }
-  buffer->has_data = true;
-  buffer->len = len;
   buffer->data_ready.notify_one();
 }
 
@@ -83,5 +95,5 @@ SDRHandler::SDRHandler(int sample_frequency, int n_buffers, size_t buffer_len)
 {
   this->sample_frequency = sample_frequency;
   this->buffer_len = buffer_len;
-  this->dev = init_rtlsdr(1090000000, 2000000);
+  this->dev = init_rtlsdr(1090000000, sample_frequency);
 }
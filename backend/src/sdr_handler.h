@@ -2,7 +2,9 @@
 #define ADSBOOST_SDR_HANDLER_H_
 
 #include <array>
+#include <chrono>
 #include <condition_variable>
+#include <cstdint>
 #include <mutex>
 #include <thread>
 
@@ -17,6 +19,13 @@ struct SharedBuffer {
   bool has_data = false;
   bool has_more = true;
   size_t len = BUFFER_LEN + BUFFER_OVERLAP;
+  // absolute sample index of data[BUFFER_OVERLAP], the first new sample
+  uint64_t first_sample = 0;
+  // number of samples in the stream so far
+  uint64_t n_samples = 0;
+  // time of the first sample in the stream
+  std::chrono::system_clock::time_point stream_start;
+  int sample_rate = SAMPLE_RATE;
 };
 
 class SDRHandler {
@@ -0,0 +1,200 @@
+#include "sharded_contact_list.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <sstream>
+#include <thread>
+
+ShardedContactList::ShardedContactList(int n_shards,
+                                       const ContactList& settings) {
+  ContactList empty = settings;
+  empty.contacts.clear();
+  empty.events.clear();
+  for (int n = 0; n < std::max(1, n_shards); n++) {
+    shards.push_back(std::make_unique<Shard>(empty));
+  }
+}
+
+size_t ShardedContactList::n_shards() const { return shards.size(); }
+
+size_t ShardedContactList::shard_of(const std::string& icao) const {
+  uint32_t address = std::strtoul(icao.c_str(), nullptr, 16);
+  // addresses are assigned in blocks per country, spread them first
+  uint32_t hash = address * 0x9e3779b1u;
+  return (uint64_t{hash} * shards.size()) >> 32;
+}
+
+void ShardedContactList::set_clock(Clock* clock) {
+  for (auto& shard : shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    shard->contacts.clock = clock;
+    for (Contact& contact : shard->contacts.contacts) {
+      contact.clock = clock;
+    }
+  }
+}
+
+bool ShardedContactList::update(const ADSBMessage& message) {
+  Shard& shard = *shards[shard_of(message.icao)];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  return shard.contacts.update(message);
+}
+
+bool ShardedContactList::update(const std::vector<ADSBMessage>& messages,
+                                int n_threads) {
+  std::vector<std::vector<const ADSBMessage*>> shard_messages(shards.size());
+  for (const ADSBMessage& message : messages) {
+    if (is_tracked_format(message.downlink_format)) {
+      shard_messages[shard_of(message.icao)].push_back(&message);
+    }
+  }
+
+  std::atomic<size_t> next_shard = 0;
+  std::atomic<bool> alert_changed = false;
+  auto worker = [&]() {
+    for (size_t n = next_shard++; n < shards.size(); n = next_shard++) {
+      if (shard_messages[n].empty()) continue;
+      std::lock_guard<std::mutex> lock(shards[n]->mutex);
+      bool changed = false;
+      for (const ADSBMessage* message : shard_messages[n]) {
+        changed |= shards[n]->contacts.update(*message);
+      }
+      if (changed) alert_changed = true;
+    }
+  };
+
+  n_threads = std::min<int>(n_threads, shards.size());
+  std::vector<std::thread> threads;
+  for (int n = 1; n < n_threads; n++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (std::thread& thread : threads) {
+    thread.join();
+  }
+  return alert_changed;
+}
+
+void ShardedContactList::expire() {
+  auto locks = lock_all();
+  for (auto& shard : shards) {
+    shard->contacts.get_contacts();
+  }
+}
+
+size_t ShardedContactList::restore(std::vector<Contact> contacts) {
+  size_t n_restored = 0;
+  for (Contact& contact : contacts) {
+    Shard& shard = *shards[shard_of(contact.icao)];
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    ContactList& list = shard.contacts;
+    contact.clock = list.clock;
+    if (list.position_ref_status == KNOWN) {
+      contact.position_ref_status = KNOWN;
+      contact.lat_ref = list.lat_ref;
+      contact.lon_ref = list.lon_ref;
+      contact.max_range_nm = list.max_range_nm;
+    }
+    if (contact.last_seen() >= list.timeout ||
+        list.get_contact(contact.icao) != nullptr) {
+      continue;
+    }
+    if (list.registry != nullptr) contact.lookup_registry(*list.registry);
+    list.contacts.push_back(std::move(contact));
+    n_restored++;
+  }
+  return n_restored;
+}
+
+std::vector<ContactEvent> ShardedContactList::take_events() {
+  std::vector<ContactEvent> events;
+  for (auto& shard : shards) {
+    std::lock_guard<std::mutex> lock(shard->mutex);
+    for (ContactEvent& event : shard->contacts.take_events()) {
+      events.push_back(std::move(event));
+    }
+  }
+  std::stable_sort(events.begin(), events.end(),
+                   [](const ContactEvent& a, const ContactEvent& b) {
+                     return a.timestamp < b.timestamp;
+                   });
+  return events;
+}
+
+std::vector<Contact> ShardedContactList::snapshot() {
+  auto locks = lock_all();
+  std::vector<Contact> contacts;
+  for (Contact* contact : sorted_contacts()) {
+    // swap in an empty track so that the ring is not copied under the locks
+    TrackHistory track;
+    std::swap(track, contact->track);
+    contacts.push_back(*contact);
+    std::swap(track, contact->track);
+  }
+  return contacts;
+}
+
+std::string ShardedContactList::to_json(bool extrapolate) {
+  auto locks = lock_all();
+  std::vector<Contact*> contacts = sorted_contacts();
+  std::stringstream ss;
+  ss << "{\"contacts\": [";
+  for (size_t n = 0; n < contacts.size(); n++) {
+    if (n > 0) ss << ",";
+    ss << contacts[n]->to_json(extrapolate);
+  }
+  ss << "]}";
+  return ss.str();
+}
+
+std::string ShardedContactList::history_json(const std::string& icao,
+                                             std::chrono::seconds max_age) {
+  Shard& shard = *shards[shard_of(icao)];
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  Contact* contact = shard.contacts.get_contact(icao);
+  if (contact == nullptr) {
+    return "";
+  }
+  auto start = std::chrono::system_clock::time_point::min();
+  if (max_age.count() > 0) {
+    start = shard.contacts.clock->now() - max_age;
+  }
+  std::stringstream ss;
+  ss << "{\"icao\": \"" << contact->icao << "\",";
+  ss << "\"track\": " << contact->track.to_json(start) << "}";
+  return ss.str();
+}
+
+size_t ShardedContactList::size() {
+  auto locks = lock_all();
+  size_t n_contacts = 0;
+  for (auto& shard : shards) {
+    n_contacts += shard->contacts.contacts.size();
+  }
+  return n_contacts;
+}
+
+std::vector<std::unique_lock<std::mutex>> ShardedContactList::lock_all() {
+  std::vector<std::unique_lock<std::mutex>> locks;
+  for (auto& shard : shards) {
+    locks.emplace_back(shard->mutex);
+  }
+  return locks;
+}
+
+std::vector<Contact*> ShardedContactList::sorted_contacts() {
+  std::vector<Contact*> contacts;
+  for (auto& shard : shards) {
+    for (Contact& contact : shard->contacts.contacts) {
+      contacts.push_back(&contact);
+    }
+  }
+  std::sort(contacts.begin(), contacts.end(), [](Contact* a, Contact* b) {
+    if (a->first_message != b->first_message) {
+      return a->first_message > b->first_message;
+    }
+    return a->icao < b->icao;
+  });
+  return contacts;
+}
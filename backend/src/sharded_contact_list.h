@@ -0,0 +1,74 @@
+#ifndef ADSBOOST_SHARDED_CONTACT_LIST_H_
+#define ADSBOOST_SHARDED_CONTACT_LIST_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "config.h"
+#include "contact.h"
+
+// Contacts partitioned by address into shards with a lock each. An update only
+// locks the shard of its address, so messages of different aircraft are
+// applied concurrently. Operations over all contacts lock every shard in index
+// order and see a consistent state.
+class ShardedContactList {
+ public:
+  // every shard takes the settings (timeout, reference position, range, event
+  // collection, clock) of the given list
+  ShardedContactList(int n_shards, const ContactList& settings);
+
+  size_t n_shards() const;
+  size_t shard_of(const std::string& icao) const;
+  void set_clock(Clock* clock);
+
+  // returns whether a contact raised, changed or cleared an alert
+  bool update(const ADSBMessage& message);
+  // applies the messages of tracked formats on up to n_threads threads, each
+  // shard on one thread in message order
+  bool update(const std::vector<ADSBMessage>& messages, int n_threads);
+  // removes the timed out contacts
+  void expire();
+  // adds contacts of a snapshot that are neither known nor timed out, with
+  // the settings of this list, returns how many were added
+  size_t restore(std::vector<Contact> contacts);
+  // events of all shards ordered by time
+  std::vector<ContactEvent> take_events();
+
+  // copies of the contacts without their tracks (see history_json), newest
+  // first by their first message
+  std::vector<Contact> snapshot();
+  // extrapolate moves the positions to the current time, see Contact
+  std::string to_json(bool extrapolate = false);
+  // track of the contact over the last max_age (all of it if zero), empty if
+  // the contact is unknown
+  std::string history_json(const std::string& icao,
+                           std::chrono::seconds max_age);
+  size_t size();
+
+ private:
+  struct Shard {
+    std::mutex mutex;
+    ContactList contacts;
+    explicit Shard(const ContactList& settings) : contacts(settings) {}
+  };
+  std::vector<std::unique_ptr<Shard>> shards;
+
+  std::vector<std::unique_lock<std::mutex>> lock_all();
+  // requires the locks of all shards
+  std::vector<Contact*> sorted_contacts();
+};
+
+struct SharedContactList {
+  ShardedContactList contact_list =
+      ShardedContactList(CONTACT_SHARDS, ContactList(10));
+  // guards contacts_updated, the contact list locks its shards itself
+  std::mutex mutex;
+  std::condition_variable contacts_ready;
+  bool contacts_updated = false;
+};
+
+#endif  // ADSBOOST_SHARDED_CONTACT_LIST_H_
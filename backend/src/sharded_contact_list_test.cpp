@@ -0,0 +1,161 @@
+#include "sharded_contact_list.h"
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include "clock.h"
+
+class ShardedContactListTest : public ::testing::Test {
+ protected:
+  ShardedContactListTest() {}
+
+  // identification and airborne position frames of n_aircraft aircraft,
+  // interleaved as they would be received
+  std::vector<ADSBMessage> make_messages(int n_aircraft, int n_rounds) {
+    std::array<unsigned char, 14> identification = {
+        0x8d, 0x44, 0x0c, 0x36, 0x23, 0x14, 0xa5,
+        0x76, 0xc8, 0xb2, 0xa0, 0x73, 0x76, 0xfe};
+    std::array<unsigned char, 14> position = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                              0xc3, 0x82, 0xd6, 0x90, 0xc8,
+                                              0xac, 0x28, 0x63, 0xa7};
+    auto start = std::chrono::system_clock::time_point(std::chrono::hours(1));
+    std::vector<ADSBMessage> messages;
+    for (int round = 0; round < n_rounds; round++) {
+      for (int aircraft = 0; aircraft < n_aircraft; aircraft++) {
+        std::array<unsigned char, 14> frame =
+            (round % 2 == 0) ? identification : position;
+        frame[1] = 0x40 + (aircraft >> 16);
+        frame[2] = aircraft >> 8;
+        frame[3] = aircraft;
+        auto timestamp = start + std::chrono::milliseconds(
+                                     10 * (round * n_aircraft + aircraft));
+        messages.push_back(ADSBMessage(frame, timestamp));
+      }
+    }
+    return messages;
+  }
+};
+
+TEST_F(ShardedContactListTest, CheckShardOf) {
+  ShardedContactList contacts(8, ContactList(10));
+  EXPECT_EQ(contacts.n_shards(), 8);
+  std::vector<int> counts(8, 0);
+  for (int address = 0x400000; address < 0x400400; address++) {
+    char icao[7];
+    std::snprintf(icao, sizeof(icao), "%06X", address);
+    size_t shard = contacts.shard_of(icao);
+    ASSERT_LT(shard, 8);
+    EXPECT_EQ(shard, contacts.shard_of(icao));
+    counts[shard]++;
+  }
+  // a block of consecutive addresses is spread over all shards
+  for (int count : counts) {
+    EXPECT_GT(count, 64);
+  }
+}
+
+TEST_F(ShardedContactListTest, CheckMatchesContactList) {
+  std::vector<ADSBMessage> messages = make_messages(50, 4);
+  VirtualClock clock;
+  clock.advance(messages.back().timestamp);
+
+  ContactList settings = ContactList(90, 52.0, 4.0);
+  settings.clock = &clock;
+  ContactList single = settings;
+  for (const ADSBMessage& message : messages) {
+    single.update(message);
+  }
+  ShardedContactList sharded(4, settings);
+  for (const ADSBMessage& message : messages) {
+    sharded.update(message);
+  }
+  EXPECT_EQ(sharded.size(), 50);
+  // both list the newest contact first
+  EXPECT_EQ(sharded.to_json(), single.to_json());
+}
+
+TEST_F(ShardedContactListTest, CheckParallelUpdate) {
+  std::vector<ADSBMessage> messages = make_messages(200, 6);
+  VirtualClock clock;
+  clock.advance(messages.back().timestamp);
+  ContactList settings = ContactList(90);
+  settings.clock = &clock;
+
+  ShardedContactList sequential(16, settings);
+  sequential.update(messages, 1);
+  ShardedContactList parallel(16, settings);
+  parallel.update(messages, 4);
+
+  EXPECT_EQ(parallel.size(), 200);
+  EXPECT_EQ(parallel.to_json(), sequential.to_json());
+  for (const Contact& contact : parallel.snapshot()) {
+    EXPECT_EQ(contact.n_messages, 6);
+  }
+}
+
+TEST_F(ShardedContactListTest, CheckConcurrentUpdateAndJson) {
+  std::vector<ADSBMessage> messages = make_messages(64, 8);
+  VirtualClock clock;
+  clock.advance(messages.back().timestamp);
+  ContactList settings = ContactList(90);
+  settings.clock = &clock;
+  ShardedContactList contacts(8, settings);
+
+  // every thread feeds its own aircraft, a reader serializes meanwhile
+  std::vector<std::thread> writers;
+  for (int n = 0; n < 4; n++) {
+    writers.emplace_back([&messages, &contacts, n]() {
+      for (size_t m = n; m < messages.size(); m += 4) {
+        contacts.update(messages[m]);
+      }
+    });
+  }
+  size_t n_seen = 0;
+  for (int n = 0; n < 50; n++) {
+    std::vector<Contact> snapshot = contacts.snapshot();
+    EXPECT_GE(snapshot.size(), n_seen);
+    n_seen = snapshot.size();
+  }
+  for (std::thread& writer : writers) {
+    writer.join();
+  }
+  EXPECT_EQ(contacts.size(), 64);
+  for (const Contact& contact : contacts.snapshot()) {
+    EXPECT_EQ(contact.n_messages, 8);
+  }
+}
+
+TEST_F(ShardedContactListTest, CheckExpire) {
+  std::vector<ADSBMessage> messages = make_messages(10, 1);
+  VirtualClock clock;
+  clock.advance(messages.back().timestamp);
+  ContactList settings = ContactList(10);
+  settings.clock = &clock;
+  ShardedContactList contacts(4, settings);
+  contacts.update(messages, 2);
+  contacts.expire();
+  EXPECT_EQ(contacts.size(), 10);
+
+  clock.advance(messages.back().timestamp + std::chrono::seconds(20));
+  contacts.expire();
+  EXPECT_EQ(contacts.size(), 0);
+  EXPECT_EQ(contacts.to_json(), "{\"contacts\": []}");
+}
+
+TEST_F(ShardedContactListTest, CheckEventsOrderedByTime) {
+  std::vector<ADSBMessage> messages = make_messages(20, 1);
+  ContactList settings = ContactList(90);
+  settings.collect_events = true;
+  ShardedContactList contacts(4, settings);
+  contacts.update(messages, 4);
+  std::vector<ContactEvent> events = contacts.take_events();
+  ASSERT_EQ(events.size(), 20);
+  for (size_t n = 0; n < events.size(); n++) {
+    EXPECT_EQ(events[n].type, NEW_CONTACT_EVENT);
+    EXPECT_EQ(events[n].icao, messages[n].icao);
+  }
+  EXPECT_TRUE(contacts.take_events().empty());
+}
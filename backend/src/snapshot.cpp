@@ -0,0 +1,61 @@
+#include "snapshot.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+bool write_contact_snapshot(const std::string &filename,
+                            const std::vector<Contact> &contacts) {
+  std::string temp_filename = filename + ".tmp";
+  std::ofstream file(temp_filename,
+                     std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!file) {
+    std::cerr << "Error opening snapshot file for writing.\n";
+    return false;
+  }
+
+  std::vector<ContactRecord> records;
+  records.reserve(contacts.size());
+  for (const Contact &contact : contacts) {
+    records.push_back(contact.to_record());
+  }
+  uint32_t record_size = sizeof(ContactRecord);
+  file.write(CONTACT_SNAPSHOT_MAGIC, std::strlen(CONTACT_SNAPSHOT_MAGIC));
+  file.write(reinterpret_cast<const char *>(&record_size),
+             sizeof(record_size));
+  file.write(reinterpret_cast<const char *>(records.data()),
+             records.size() * sizeof(ContactRecord));
+  file.close();
+  if (!file) {
+    std::cerr << "Error writing snapshot file.\n";
+    std::remove(temp_filename.c_str());
+    return false;
+  }
+  return std::rename(temp_filename.c_str(), filename.c_str()) == 0;
+}
+
+bool read_contact_snapshot(const std::string &filename,
+                           std::vector<Contact> *contacts) {
+  std::ifstream file(filename, std::ios::in | std::ios::binary);
+  if (!file) {
+    return false;
+  }
+
+  char magic[sizeof(CONTACT_SNAPSHOT_MAGIC) - 1];
+  uint32_t record_size = 0;
+  file.read(magic, sizeof(magic));
+  file.read(reinterpret_cast<char *>(&record_size), sizeof(record_size));
+  if (!file || std::memcmp(magic, CONTACT_SNAPSHOT_MAGIC, sizeof(magic)) != 0 ||
+      record_size != sizeof(ContactRecord)) {
+    std::cerr << "Ignoring incompatible snapshot file " << filename << ".\n";
+    return false;
+  }
+
+  ContactRecord record;
+  while (file.read(reinterpret_cast<char *>(&record), sizeof(record))) {
+    contacts->emplace_back(record);
+  }
+  return true;
+}
@@ -0,0 +1,21 @@
+#ifndef ADSBOOST_SNAPSHOT_H_
+#define ADSBOOST_SNAPSHOT_H_
+
+#include <string>
+#include <vector>
+
+#include "contact.h"
+
+// Snapshot files start with this magic and the size of a ContactRecord
+// (uint32), followed by one record per contact.
+#define CONTACT_SNAPSHOT_MAGIC "ADSBSNP1"
+
+// Writes to a temporary file that replaces the snapshot once complete, so an
+// interrupted write keeps the previous snapshot.
+bool write_contact_snapshot(const std::string &filename,
+                            const std::vector<Contact> &contacts);
+// Returns false if the file is missing or from an incompatible version.
+bool read_contact_snapshot(const std::string &filename,
+                           std::vector<Contact> *contacts);
+
+#endif  // ADSBOOST_SNAPSHOT_H_
@@ -0,0 +1,107 @@
+#include "snapshot.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include "clock.h"
+#include "sharded_contact_list.h"
+
+class SnapshotTest : public ::testing::Test {
+ protected:
+  SnapshotTest() { clock.advance(start); }
+
+  std::array<unsigned char, 14> identification = {
+      0x8d, 0x3c, 0x65, 0x85, 0x23, 0x10, 0xc2,
+      0x34, 0x04, 0x88, 0x20, 0x5a, 0x8f, 0xaf};
+  std::array<unsigned char, 14> position_even = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                                 0xc3, 0x82, 0xd6, 0x90, 0xc8,
+                                                 0xac, 0x28, 0x63, 0xa7};
+  std::array<unsigned char, 14> position_odd = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                                0xc3, 0x86, 0x43, 0x5c, 0xc4,
+                                                0x12, 0x69, 0x2a, 0xd6};
+  std::chrono::system_clock::time_point start =
+      std::chrono::system_clock::time_point(std::chrono::hours(1000));
+  VirtualClock clock;
+};
+
+TEST_F(SnapshotTest, CheckContactRecordRoundTrip) {
+  Contact contact = Contact(ADSBMessage(position_odd, start));
+  contact.update(
+      ADSBMessage(position_even, start + std::chrono::milliseconds(500)));
+  contact.clock = &clock;
+  ASSERT_EQ(contact.position_status, KNOWN);
+
+  Contact restored = Contact(contact.to_record());
+  restored.clock = &clock;
+  EXPECT_EQ(restored.to_json(), contact.to_json());
+
+  Contact named = Contact(ADSBMessage(identification, start));
+  named.clock = &clock;
+  Contact restored_named = Contact(named.to_record());
+  restored_named.clock = &clock;
+  EXPECT_EQ(restored_named.callsign, "DLH4AH  ");
+  EXPECT_EQ(restored_named.aircraft_category, "MED2");
+  EXPECT_EQ(restored_named.to_json(), named.to_json());
+}
+
+TEST_F(SnapshotTest, CheckPendingCprFrame) {
+  std::string filename = testing::TempDir() + "snapshot_test_pending.bin";
+  std::remove(filename.c_str());
+  // only the odd frame was received before the restart
+  Contact contact = Contact(ADSBMessage(position_odd, start));
+  ASSERT_TRUE(write_contact_snapshot(filename, {contact}));
+
+  std::vector<Contact> contacts;
+  ASSERT_TRUE(read_contact_snapshot(filename, &contacts));
+  ASSERT_EQ(contacts.size(), 1);
+  EXPECT_EQ(contacts[0].icao, "40621D");
+  EXPECT_EQ(contacts[0].position_status, UNDETERMINED);
+  contacts[0].update(
+      ADSBMessage(position_even, start + std::chrono::seconds(1)));
+  EXPECT_EQ(contacts[0].position_status, KNOWN);
+  EXPECT_NEAR(contacts[0].lat, 52.25720, 1e-4);
+  EXPECT_NEAR(contacts[0].lon, 3.91937, 1e-4);
+  std::remove(filename.c_str());
+}
+
+TEST_F(SnapshotTest, CheckRestoreRespectsAge) {
+  std::string filename = testing::TempDir() + "snapshot_test_age.bin";
+  std::remove(filename.c_str());
+  ShardedContactList contacts(4, ContactList(30, 52.0, 4.0));
+  contacts.set_clock(&clock);
+  contacts.update(ADSBMessage(position_odd, start));
+  contacts.update(
+      ADSBMessage(identification, start + std::chrono::seconds(20)));
+  ASSERT_TRUE(write_contact_snapshot(filename, contacts.snapshot()));
+
+  ShardedContactList restarted(8, ContactList(30, 52.0, 4.0));
+  restarted.set_clock(&clock);
+  clock.advance(start + std::chrono::seconds(40));
+  std::vector<Contact> snapshot;
+  ASSERT_TRUE(read_contact_snapshot(filename, &snapshot));
+  ASSERT_EQ(snapshot.size(), 2);
+  // the first contact timed out during the restart
+  EXPECT_EQ(restarted.restore(snapshot), 1);
+  EXPECT_EQ(restarted.size(), 1);
+  EXPECT_EQ(restarted.snapshot()[0].icao, "3C6585");
+  EXPECT_EQ(restarted.snapshot()[0].lat_ref, 52.0);
+  // contacts that are already known are kept
+  EXPECT_EQ(restarted.restore(snapshot), 0);
+  std::remove(filename.c_str());
+}
+
+TEST_F(SnapshotTest, CheckIncompatibleFile) {
+  std::string filename = testing::TempDir() + "snapshot_test_invalid.bin";
+  std::vector<Contact> contacts;
+  std::remove(filename.c_str());
+  EXPECT_FALSE(read_contact_snapshot(filename, &contacts));
+
+  std::ofstream file(filename, std::ios::binary);
+  file << "ADSBSNP1" << "not a record size";
+  file.close();
+  EXPECT_FALSE(read_contact_snapshot(filename, &contacts));
+  EXPECT_TRUE(contacts.empty());
+  std::remove(filename.c_str());
+}
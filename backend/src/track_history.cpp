@@ -0,0 +1,97 @@
+#include "track_history.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "cpr.h"
+
+TrackHistory::TrackHistory(size_t capacity)
+    : max_samples(std::max<size_t>(capacity, 1)) {}
+
+bool TrackHistory::add(const TrackSample& new_sample) {
+  if (!ring.empty()) {
+    const TrackSample& last = sample(ring.size() - 1);
+    double interval = std::chrono::duration<double>(new_sample.timestamp -
+                                                    last.timestamp)
+                          .count();
+    if (interval <= 0) {
+      return false;
+    }
+    double moved =
+        distance_nm(last.lat, last.lon, new_sample.lat, new_sample.lon);
+    double turned =
+        std::abs(std::remainder(new_sample.heading - last.heading, 360.0));
+    if (moved < TRACK_MIN_DISTANCE_NM && turned < TRACK_MIN_TURN_DEG &&
+        interval < TRACK_MAX_INTERVAL_S) {
+      return false;
+    }
+  } else {
+    ring.reserve(max_samples);
+  }
+
+  if (ring.size() < max_samples) {
+    ring.push_back(new_sample);
+  } else {
+    ring[head] = new_sample;
+    head = (head + 1) % max_samples;
+  }
+  return true;
+}
+
+size_t TrackHistory::size() const { return ring.size(); }
+
+size_t TrackHistory::capacity() const { return max_samples; }
+
+const TrackSample& TrackHistory::sample(size_t n) const {
+  return ring[(head + n) % ring.size()];
+}
+
+std::vector<TrackSample> TrackHistory::since(
+    std::chrono::system_clock::time_point start) const {
+  std::vector<TrackSample> samples;
+  for (size_t n = 0; n < ring.size(); n++) {
+    if (sample(n).timestamp >= start) {
+      samples.push_back(sample(n));
+    }
+  }
+  return samples;
+}
+
+std::vector<TrackSample> TrackHistory::samples() const {
+  return since(std::chrono::system_clock::time_point::min());
+}
+
+bool TrackHistory::at(std::chrono::system_clock::time_point time,
+                      TrackSample* result) const {
+  for (size_t n = ring.size(); n > 0; n--) {
+    if (sample(n - 1).timestamp <= time) {
+      *result = sample(n - 1);
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string TrackHistory::to_json(
+    std::chrono::system_clock::time_point start) const {
+  std::stringstream ss;
+  ss << "[";
+  bool first = true;
+  for (const TrackSample& track_sample : since(start)) {
+    if (!first) ss << ",";
+    first = false;
+    ss << "{\"timestamp\": "
+       << std::chrono::duration_cast<std::chrono::milliseconds>(
+              track_sample.timestamp.time_since_epoch())
+              .count()
+       << ",";
+    ss << "\"lat\": " << track_sample.lat << ",";
+    ss << "\"lon\": " << track_sample.lon << ",";
+    ss << "\"altitude\": " << track_sample.altitude << ",";
+    ss << "\"speed\": " << track_sample.speed << ",";
+    ss << "\"heading\": " << track_sample.heading << "}";
+  }
+  ss << "]";
+  return ss.str();
+}
@@ -0,0 +1,54 @@
+#ifndef ADSBOOST_TRACK_HISTORY_H_
+#define ADSBOOST_TRACK_HISTORY_H_
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "config.h"
+
+// Positions are stored as floats, which resolves a few meters.
+struct TrackSample {
+  std::chrono::system_clock::time_point timestamp;
+  float lat;
+  float lon;
+  int32_t altitude;
+  float speed;
+  float heading;
+};
+
+static_assert(sizeof(TrackSample) == 32, "track memory estimate in README");
+
+// Fixed capacity ring of past positions of a contact, the oldest sample is
+// overwritten once it is full. Samples closer than TRACK_MIN_DISTANCE_NM to
+// the last kept one are dropped unless the track turned by
+// TRACK_MIN_TURN_DEG or TRACK_MAX_INTERVAL_S passed.
+class TrackHistory {
+ public:
+  explicit TrackHistory(size_t capacity = TRACK_HISTORY_CAPACITY);
+
+  // returns whether the sample was kept
+  bool add(const TrackSample& sample);
+  size_t size() const;
+  size_t capacity() const;
+  // samples at or after the given time, oldest first
+  std::vector<TrackSample> since(
+      std::chrono::system_clock::time_point start) const;
+  std::vector<TrackSample> samples() const;
+  // last sample at or before the given time, false if the history starts
+  // later
+  bool at(std::chrono::system_clock::time_point time,
+          TrackSample* sample) const;
+  std::string to_json(std::chrono::system_clock::time_point start) const;
+
+ private:
+  size_t max_samples;
+  // allocated with the first sample, then used as ring from head
+  std::vector<TrackSample> ring;
+  size_t head = 0;
+
+  const TrackSample& sample(size_t n) const;
+};
+
+#endif  // ADSBOOST_TRACK_HISTORY_H_
@@ -0,0 +1,162 @@
+#include "track_history.h"
+
+#include <gtest/gtest.h>
+
+#include "clock.h"
+#include "contact.h"
+#include "sharded_contact_list.h"
+
+class TrackHistoryTest : public ::testing::Test {
+ protected:
+  TrackHistoryTest() {}
+
+  std::chrono::system_clock::time_point start =
+      std::chrono::system_clock::time_point(std::chrono::hours(1));
+
+  // one sample per minute flying north, 0.1 degrees latitude apart
+  TrackSample northbound(int n) {
+    return {start + std::chrono::minutes(n), 50.0f + 0.1f * n, 8.0f,
+            30000 + n, 450.0f, 0.0f};
+  }
+};
+
+TEST_F(TrackHistoryTest, CheckRingWrapsAround) {
+  TrackHistory track(4);
+  EXPECT_EQ(track.capacity(), 4);
+  EXPECT_EQ(track.size(), 0);
+  for (int n = 0; n < 6; n++) {
+    EXPECT_TRUE(track.add(northbound(n)));
+  }
+  EXPECT_EQ(track.size(), 4);
+
+  std::vector<TrackSample> samples = track.samples();
+  ASSERT_EQ(samples.size(), 4);
+  for (int n = 0; n < 4; n++) {
+    EXPECT_EQ(samples[n].timestamp, northbound(n + 2).timestamp);
+    EXPECT_EQ(samples[n].altitude, 30002 + n);
+  }
+}
+
+TEST_F(TrackHistoryTest, CheckDownsampling) {
+  TrackHistory track(16);
+  TrackSample sample = northbound(0);
+  EXPECT_TRUE(track.add(sample));
+
+  // not moved far enough
+  sample.timestamp += std::chrono::seconds(5);
+  sample.lat += 0.005f;
+  EXPECT_FALSE(track.add(sample));
+
+  // turned
+  sample.timestamp += std::chrono::seconds(5);
+  sample.heading = 355.0f;
+  EXPECT_FALSE(track.add(sample));
+  sample.heading = 345.0f;
+  EXPECT_TRUE(track.add(sample));
+
+  // moved
+  sample.timestamp += std::chrono::seconds(5);
+  sample.lat += 0.01f;
+  EXPECT_TRUE(track.add(sample));
+
+  // nothing changed for a while
+  sample.timestamp += std::chrono::seconds(30);
+  EXPECT_FALSE(track.add(sample));
+  sample.timestamp += std::chrono::seconds(TRACK_MAX_INTERVAL_S);
+  EXPECT_TRUE(track.add(sample));
+
+  // out of order
+  sample.timestamp -= std::chrono::seconds(1);
+  sample.lat += 1.0f;
+  EXPECT_FALSE(track.add(sample));
+
+  EXPECT_EQ(track.size(), 4);
+}
+
+TEST_F(TrackHistoryTest, CheckQueries) {
+  TrackHistory track(8);
+  TrackSample sample;
+  EXPECT_FALSE(track.at(start, &sample));
+  for (int n = 0; n < 5; n++) {
+    track.add(northbound(n));
+  }
+
+  std::vector<TrackSample> recent = track.since(northbound(3).timestamp);
+  ASSERT_EQ(recent.size(), 2);
+  EXPECT_EQ(recent[0].altitude, 30003);
+  EXPECT_EQ(recent[1].altitude, 30004);
+  EXPECT_TRUE(track.since(northbound(5).timestamp).empty());
+
+  EXPECT_FALSE(track.at(start - std::chrono::seconds(1), &sample));
+  ASSERT_TRUE(track.at(start + std::chrono::seconds(150), &sample));
+  EXPECT_EQ(sample.altitude, 30002);
+  ASSERT_TRUE(track.at(start + std::chrono::hours(1), &sample));
+  EXPECT_EQ(sample.altitude, 30004);
+}
+
+TEST_F(TrackHistoryTest, CheckToJson) {
+  TrackHistory track(8);
+  EXPECT_EQ(track.to_json(start), "[]");
+  track.add({start, 52.5f, 3.75f, 38000, 420.0f, 90.0f});
+  EXPECT_EQ(track.to_json(start),
+            "[{\"timestamp\": 3600000,\"lat\": 52.5,\"lon\": 3.75,"
+            "\"altitude\": 38000,\"speed\": 420,\"heading\": 90}]");
+  EXPECT_EQ(track.to_json(start + std::chrono::seconds(1)), "[]");
+}
+
+TEST_F(TrackHistoryTest, CheckContactTrack) {
+  std::array<unsigned char, 14> message_even = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                                0xc3, 0x82, 0xd6, 0x90, 0xc8,
+                                                0xac, 0x28, 0x63, 0xa7};
+  std::array<unsigned char, 14> message_odd = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                               0xc3, 0x86, 0x43, 0x5c, 0xc4,
+                                               0x12, 0x69, 0x2a, 0xd6};
+  Contact contact = Contact(ADSBMessage(message_odd, start));
+  EXPECT_EQ(contact.track.size(), 0);
+  contact.update(ADSBMessage(message_even, start + std::chrono::seconds(1)));
+  ASSERT_EQ(contact.track.size(), 1);
+  TrackSample sample = contact.track.samples()[0];
+  EXPECT_EQ(sample.timestamp, start + std::chrono::seconds(1));
+  EXPECT_NEAR(sample.lat, 52.25720, 1e-4);
+  EXPECT_NEAR(sample.lon, 3.91937, 1e-4);
+  EXPECT_EQ(sample.altitude, 38000);
+
+  // same position again is only kept after the maximum interval
+  contact.update(ADSBMessage(message_even, start + std::chrono::seconds(20)));
+  EXPECT_EQ(contact.track.size(), 1);
+  contact.update(ADSBMessage(message_even, start + std::chrono::seconds(75)));
+  EXPECT_EQ(contact.track.size(), 2);
+}
+
+TEST_F(TrackHistoryTest, CheckHistoryJson) {
+  std::array<unsigned char, 14> message_even = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                                0xc3, 0x82, 0xd6, 0x90, 0xc8,
+                                                0xac, 0x28, 0x63, 0xa7};
+  std::array<unsigned char, 14> message_odd = {0x8d, 0x40, 0x62, 0x1d, 0x58,
+                                               0xc3, 0x86, 0x43, 0x5c, 0xc4,
+                                               0x12, 0x69, 0x2a, 0xd6};
+  VirtualClock clock;
+  ShardedContactList contacts(4, ContactList(600));
+  contacts.set_clock(&clock);
+  clock.advance(start);
+  contacts.update(ADSBMessage(message_odd, start));
+  contacts.update(ADSBMessage(message_even, start + std::chrono::seconds(1)));
+  contacts.update(ADSBMessage(message_even, start + std::chrono::seconds(30)));
+  clock.advance(start + std::chrono::seconds(80));
+  contacts.update(ADSBMessage(message_even, start + std::chrono::seconds(80)));
+
+  EXPECT_EQ(contacts.history_json("ABCDEF", std::chrono::seconds(0)), "");
+  std::string all = contacts.history_json("40621D", std::chrono::seconds(0));
+  EXPECT_EQ(all.find("{\"icao\": \"40621D\",\"track\": [{\"timestamp\": "
+                     "3601000,"),
+            0);
+  EXPECT_NE(all.find("\"timestamp\": 3680000,"), std::string::npos);
+  std::string recent =
+      contacts.history_json("40621D", std::chrono::seconds(60));
+  EXPECT_EQ(recent.find("3601000"), std::string::npos);
+  EXPECT_NE(recent.find("\"timestamp\": 3680000,"), std::string::npos);
+
+  // snapshots leave the track to history_json
+  EXPECT_EQ(contacts.snapshot()[0].track.size(), 0);
+  EXPECT_EQ(contacts.history_json("40621D", std::chrono::seconds(0)), all);
+}
@@ -2,22 +2,78 @@
 
 #include <time.h>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
 #include <iostream>
 #include <thread>
 
 uWS::App *globalApp;
+// loop of the webserver thread, null until it runs
+std::atomic<uWS::Loop *> globalLoop = nullptr;
+
+void broadcast(SharedContactList *shared_contacts) {
+  std::string json = shared_contacts->contact_list.to_json(true);
+  globalApp->publish("broadcast", std::string_view(json), uWS::OpCode::TEXT,
+                     false);
+  std::unique_lock<std::mutex> lock{shared_contacts->mutex};
+  shared_contacts->contacts_updated = false;
+}
 
 void broadcast_callback(us_timer_t *timer) {
   SharedContactList **shared_contacts =
       reinterpret_cast<SharedContactList **>(us_timer_ext(timer));
-  {
-    std::unique_lock<std::mutex> lock{(*shared_contacts)->mutex};
-    globalApp->publish(
-        "broadcast",
-        std::string_view((*shared_contacts)->contact_list.to_json()),
-        uWS::OpCode::TEXT, false);
-    (*shared_contacts)->contacts_updated = false;
+  broadcast(*shared_contacts);
+}
+
+void broadcast_now(SharedContactList *contacts) {
+  uWS::Loop *loop = globalLoop.load();
+  if (loop == nullptr) {
+    return;
+  }
+  // runs on the webserver thread with its next loop iteration
+  loop->defer([contacts]() { broadcast(contacts); });
+}
+
+void publish_events(std::vector<ContactEvent> events) {
+  uWS::Loop *loop = globalLoop.load();
+  if (loop == nullptr || events.empty()) {
+    return;
+  }
+  std::vector<std::string> messages;
+  for (ContactEvent &event : events) {
+    messages.push_back(event.to_json());
+  }
+  loop->defer([messages]() {
+    for (const std::string &message : messages) {
+      globalApp->publish("events", message, uWS::OpCode::TEXT, false);
+    }
+  });
+}
+
+// the status line has to be written before any header
+template <typename Response>
+void serve_history(SharedContactList *contacts, Response *res,
+                   uWS::HttpRequest *req) {
+  std::string icao(req->getParameter(0));
+  std::transform(icao.begin(), icao.end(), icao.begin(), ::toupper);
+  int max_age_s = 0;
+  std::string seconds(req->getQuery("seconds"));
+  if (!seconds.empty()) {
+    max_age_s = std::max(0, std::atoi(seconds.c_str()));
   }
+
+  std::string history = contacts->contact_list.history_json(
+      icao, std::chrono::seconds(max_age_s));
+  if (history.empty()) {
+    res->writeStatus("404 Not Found")
+        ->writeHeader("Access-Control-Allow-Origin", "*")
+        ->end("unknown contact");
+    return;
+  }
+  res->writeHeader("Access-Control-Allow-Origin", "*")
+      ->writeHeader("Content-Type", "application/json")
+      ->end(history);
 }
 
 void run_webserver(SharedContactList *contacts, int port) {
@@ -26,6 +82,22 @@ void run_webserver(SharedContactList *contacts, int port) {
   struct PerSocketData {};
   uWS::App app =
       uWS::App()
+          .ws<PerSocketData>(
+              "/events",
+              {
+                  .compression = uWS::SHARED_COMPRESSOR,
+                  .maxPayloadLength = 16 * 1024,
+                  .idleTimeout = 16,
+                  .maxBackpressure = 1 * 1024 * 1024,
+                  .closeOnBackpressureLimit = false,
+                  .resetIdleTimeoutOnSend = false,
+                  .sendPingsAutomatically = true,
+                  .open = [](auto *ws) { ws->subscribe("events"); },
+              })
+          .get("/history/:icao",
+               [contacts](auto *res, auto *req) {
+                 serve_history(contacts, res, req);
+               })
           .ws<PerSocketData>(
               "/*",
               {
@@ -58,6 +130,7 @@ void run_webserver(SharedContactList *contacts, int port) {
   us_timer_set(data_poll_timer, broadcast_callback, 100, 100);
 
   globalApp = &app;
+  globalLoop = uWS::Loop::get();
 
   app.run();
 }
\ No newline at end of file
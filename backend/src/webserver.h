@@ -3,11 +3,17 @@
 
 #include <condition_variable>
 #include <mutex>
+#include <vector>
 
 #include "App.h"
-#include "contact.h"
+#include "sharded_contact_list.h"
 
 void broadcastWhenReady(uWS::SSLApp *globalApp);
 void run_webserver(SharedContactList *contacts, int port);
+// publishes the contacts without waiting for the broadcast timer, may be
+// called from any thread
+void broadcast_now(SharedContactList *contacts);
+// publishes the events on the "events" topic of the /events endpoint
+void publish_events(std::vector<ContactEvent> events);
 
 #endif  // ADSBOOST_WEBSERVER_H_
\ No newline at end of file
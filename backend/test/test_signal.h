@@ -0,0 +1,91 @@
+#ifndef ADSBOOST_TEST_SIGNAL_H_
+#define ADSBOOST_TEST_SIGNAL_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Helpers to synthesize raw IQ data (2 MSPS unless stated otherwise, unsigned
+// 8 bit, centred on 127)
+// containing pulse position modulated Mode S frames.
+
+inline void write_chip(std::vector<unsigned char> *iq, size_t sample,
+                       int amplitude) {
+  iq->at(2 * sample) = 127 + amplitude;
+  iq->at(2 * sample + 1) = 127;
+}
+
+// Writes the preamble and the frame starting at the given sample index.
+inline void modulate_frame(std::vector<unsigned char> *iq, size_t sample,
+                           const std::array<unsigned char, 14> &frame,
+                           int amplitude = 100, int n_bits = 112) {
+  for (int chip : {0, 2, 7, 9}) {
+    write_chip(iq, sample + chip, amplitude);
+  }
+  for (int i = 0; i < n_bits; i++) {
+    int bit = (frame[i / 8] >> (7 - i % 8)) & 1;
+    write_chip(iq, sample + 16 + 2 * i + (bit ? 0 : 1), amplitude);
+  }
+}
+
+// Writes the frame starting at start_us microseconds into IQ data of the given
+// sample rate. Each sample gets the pulse amplitude weighted by the part of
+// the sample period covered by pulses.
+inline void modulate_frame_at_rate(std::vector<unsigned char> *iq,
+                                   double start_us,
+                                   const std::array<unsigned char, 14> &frame,
+                                   int sample_rate, int amplitude = 100) {
+  // chips of 0.5 us, preamble and 112 bits
+  std::vector<bool> pulses(240, false);
+  for (int chip : {0, 2, 7, 9}) {
+    pulses[chip] = true;
+  }
+  for (int i = 0; i < 112; i++) {
+    int bit = (frame[i / 8] >> (7 - i % 8)) & 1;
+    pulses[16 + 2 * i + (bit ? 0 : 1)] = true;
+  }
+  double samples_per_us = sample_rate / 1e6;
+  size_t first = start_us * samples_per_us;
+  size_t last = (start_us + 120) * samples_per_us;
+  for (size_t sample = first; sample <= last; sample++) {
+    double begin = sample / samples_per_us;
+    double end = (sample + 1) / samples_per_us;
+    double covered = 0;
+    for (int chip = 0; chip < 240; chip++) {
+      if (!pulses[chip]) continue;
+      double chip_begin = start_us + 0.5 * chip;
+      covered += std::max(
+          0.0, std::min(end, chip_begin + 0.5) - std::max(begin, chip_begin));
+    }
+    iq->at(2 * sample) =
+        127 + std::lround(amplitude * covered * samples_per_us);
+    iq->at(2 * sample + 1) = 127;
+  }
+}
+
+inline std::vector<unsigned char> silent_iq(size_t n_samples) {
+  return std::vector<unsigned char>(2 * n_samples, 127);
+}
+
+// Adds uniformly distributed noise of the given amplitude to I and Q.
+inline void add_noise(std::vector<unsigned char> *iq, int amplitude,
+                      unsigned int seed = 1) {
+  std::mt19937 generator(seed);
+  std::uniform_int_distribution<int> distribution(-amplitude, amplitude);
+  for (unsigned char &value : *iq) {
+    value = std::clamp(value + distribution(generator), 0, 255);
+  }
+}
+
+inline void write_iq_file(const std::string &filename,
+                          const std::vector<unsigned char> &iq) {
+  std::ofstream file(filename, std::ios::binary);
+  file.write(reinterpret_cast<const char *>(iq.data()), iq.size());
+}
+
+#endif  // ADSBOOST_TEST_SIGNAL_H_